@@ -10,6 +10,21 @@
 #include <ctime>
 #include <map> 
 #include <stdexcept> 
+#include <chrono>
+#include <atomic>
+#include <new>
+#include <charconv>
+#include <cmath>
+#include <type_traits>
+#include <cstdint>
+#include <unordered_map>
+#include <thread>
+#include <string_view>
+#include <cstring>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <filesystem>
 
 using namespace std;
 
@@ -21,6 +36,7 @@ const string BOOKING_FILE = "bookings_data.txt";
 const string PNR_FILE = "pnr_counter.txt";
 const string USER_FILE = "users_data.txt"; 
 const string TX_LOG_FILE = "transactions.log"; // Transaction History File
+const string TX_ROLLUP_FILE = "tx_rollup.dat"; // Time-series rollup of the transaction log
 
 // Function to clear input buffer after failed read
 void clearInputBuffer() {
@@ -28,24 +44,873 @@ void clearInputBuffer() {
     cin.ignore(numeric_limits<streamsize>::max(), '\n');
 }
 
-// Function to validate date format (Simplified MM/DD/YYYY)
-bool isValidDate(const string& date) {
-    if (date.length() != 10 || date[2] != '/' || date[5] != '/') return false;
-    // Basic numerical checks
-    if (!isdigit(date[0]) || !isdigit(date[1]) || !isdigit(date[3]) || 
-        !isdigit(date[4]) || !isdigit(date[6]) || !isdigit(date[7]) || 
-        !isdigit(date[8]) || !isdigit(date[9])) return false;
-    // Simple month/day check
-    try {
-        int month = stoi(date.substr(0, 2));
-        int day = stoi(date.substr(3, 2));
-        if (month < 1 || month > 12 || day < 1 || day > 31) return false;
-    } catch (...) {
-        return false;
+// Days since 1970-01-01 for a proleptic Gregorian date (and back)
+long long daysFromCivil(int y, int m, int d) {
+    y -= m <= 2;
+    const long long era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<long long>(doe) - 719468;
+}
+
+void civilFromDays(long long z, int& y, int& m, int& d) {
+    z += 719468;
+    const long long era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+    m = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    y = static_cast<int>(yoe + era * 400 + (m <= 2));
+}
+
+// --- Date (Compact Civil Date) ---
+// A calendar day as one int32_t day number (days since 1970-01-01): comparison, hashing
+// and day arithmetic are integer ops, and the weekday is a modulo. Parsing is strict
+// (real month lengths, leap years) and accepts MM/DD/YYYY or ISO YYYY-MM-DD; MM/DD/YYYY
+// stays the display and file form.
+class Date {
+private:
+    static constexpr int32_t INVALID = INT32_MIN;
+    int32_t days = INVALID;
+
+    explicit Date(int32_t dayNumber) : days(dayNumber) {}
+
+public:
+    Date() = default; // Invalid
+
+    static Date fromDayNumber(int32_t dayNumber) { return Date(dayNumber); }
+    static Date fromCivil(int year, int month, int day) {
+        return Date(static_cast<int32_t>(daysFromCivil(year, month, day)));
+    }
+    static Date fromKey(int32_t key) { return key < 0 ? Date() : fromCivil(key / 10000, key / 100 % 100, key % 100); }
+
+    static bool isLeapYear(int year) { return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0; }
+    static int daysInMonth(int year, int month) {
+        static const uint8_t length[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+        return length[month - 1] + (month == 2 && isLeapYear(year));
+    }
+
+    // Both layouts are 10 bytes; the eight digits are checked together with one OR of
+    // (c - '0') > 9 instead of a branch per character
+    static bool parse(string_view text, Date& out) {
+        if (text.size() != 10) return false;
+        const char* p = text.data();
+        bool iso = p[4] == '-';
+        if (iso ? p[7] != '-' : (p[2] != '/' || p[5] != '/')) return false;
+        static const uint8_t usDigits[8] = {6, 7, 8, 9, 0, 1, 3, 4}; // Year, month, day offsets
+        static const uint8_t isoDigits[8] = {0, 1, 2, 3, 5, 6, 8, 9};
+        const uint8_t* pos = iso ? isoDigits : usDigits;
+        unsigned d[8];
+        unsigned bad = 0;
+        for (int i = 0; i < 8; ++i) {
+            d[i] = static_cast<unsigned>(static_cast<unsigned char>(p[pos[i]]) - '0');
+            bad |= d[i] > 9;
+        }
+        if (bad) return false;
+        int year = static_cast<int>(d[0] * 1000 + d[1] * 100 + d[2] * 10 + d[3]);
+        int month = static_cast<int>(d[4] * 10 + d[5]);
+        int day = static_cast<int>(d[6] * 10 + d[7]);
+        if (year < 1 || month < 1 || month > 12 || day < 1 || day > daysInMonth(year, month)) return false;
+        out = fromCivil(year, month, day);
+        return true;
+    }
+
+    // Invalid Date on malformed input
+    static Date parseOr(string_view text) {
+        Date date;
+        parse(text, date);
+        return date;
+    }
+
+    static Date today(); // Local calendar day of the (capture-aware) clock, cached per day
+
+    bool valid() const { return days != INVALID; }
+    int32_t dayNumber() const { return days; }
+
+    void civil(int& year, int& month, int& day) const { civilFromDays(days, year, month, day); }
+
+    // YYYYMMDD (-1 if invalid), for ranges persisted as sortable integers
+    int32_t key() const {
+        if (!valid()) return -1;
+        int year, month, day;
+        civil(year, month, day);
+        return year * 10000 + month * 100 + day;
     }
+
+    // 0 = Monday ... 6 = Sunday; 1970-01-01 was a Thursday
+    int weekday() const { return static_cast<int>(((days + 3) % 7 + 7) % 7); }
+
+    Date operator+(int n) const { return Date(days + n); }
+    Date operator-(int n) const { return Date(days - n); }
+    int operator-(Date other) const { return days - other.days; }
+
+    bool operator==(Date o) const { return days == o.days; }
+    bool operator!=(Date o) const { return days != o.days; }
+    bool operator<(Date o) const { return days < o.days; }
+    bool operator<=(Date o) const { return days <= o.days; }
+    bool operator>(Date o) const { return days > o.days; }
+    bool operator>=(Date o) const { return days >= o.days; }
+
+    // Writes exactly 10 chars "MM/DD/YYYY" (no terminator)
+    void format(char* out) const {
+        int year, month, day;
+        civil(year, month, day);
+        out[0] = static_cast<char>('0' + month / 10); out[1] = static_cast<char>('0' + month % 10); out[2] = '/';
+        out[3] = static_cast<char>('0' + day / 10);   out[4] = static_cast<char>('0' + day % 10);   out[5] = '/';
+        out[6] = static_cast<char>('0' + year / 1000 % 10); out[7] = static_cast<char>('0' + year / 100 % 10);
+        out[8] = static_cast<char>('0' + year / 10 % 10);   out[9] = static_cast<char>('0' + year % 10);
+    }
+
+    string toString() const {
+        if (!valid()) return "";
+        char text[10];
+        format(text);
+        return string(text, sizeof(text));
+    }
+};
+
+ostream& operator<<(ostream& os, Date date) { return os << date.toString(); }
+
+// True for a strict MM/DD/YYYY or YYYY-MM-DD date
+bool isValidDate(const string& date) {
+    Date parsed;
+    return Date::parse(date, parsed);
+}
+
+// Rewrites a user-entered date into the canonical MM/DD/YYYY form used in records and
+// indexes; false (date untouched) if it does not parse
+bool normalizeDate(string& date) {
+    Date parsed;
+    if (!Date::parse(date, parsed)) return false;
+    date = parsed.toString();
     return true;
 }
 
+// MM/DD/YYYY -> YYYYMMDD so date ranges compare as integers (-1 if malformed)
+int32_t dateSortKey(const string& date) {
+    return Date::parseOr(date).key();
+}
+
+// YYYYMMDD -> MM/DD/YYYY
+string keyToDate(int32_t key) {
+    return Date::fromKey(key).toString();
+}
+
+// --- Startup Profiling Helpers (loadData phases) ---
+// One entry per phase of loadData; printed as a single summary line at boot.
+struct LoadPhaseStats {
+    string name;
+    size_t bytes = 0;
+    size_t records = 0;
+    double elapsedMs = 0.0;
+
+    double mbPerSec() const {
+        if (elapsedMs <= 0.0) return 0.0;
+        return (bytes / (1024.0 * 1024.0)) / (elapsedMs / 1000.0);
+    }
+
+    string summary() const {
+        stringstream ss;
+        ss << name << ": " << bytes << " B, " << records << " rec, "
+           << fixed << setprecision(3) << elapsedMs << " ms, "
+           << setprecision(2) << mbPerSec() << " MB/s";
+        return ss.str();
+    }
+};
+
+// Milliseconds elapsed since 'start' (steady clock)
+double elapsedMsSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// --- Allocation Profiling (build with -DRAIL_ALLOC_PROFILE) ---
+// Replaces global operator new/delete with versions that bump thread-local counters,
+// so benchmarks can report allocations/op and bytes/op. Without the flag the
+// counters read as zero and the default allocator is untouched.
+struct AllocStats {
+    unsigned long long count = 0;
+    unsigned long long bytes = 0;
+};
+
+#ifdef RAIL_ALLOC_PROFILE
+thread_local AllocStats threadAllocStats;
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete" // malloc/free pairing is intentional here
+#endif
+void* operator new(size_t bytes) {
+    threadAllocStats.count++;
+    threadAllocStats.bytes += bytes;
+    if (void* p = malloc(bytes ? bytes : 1)) return p;
+    throw bad_alloc();
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+const bool allocProfilingEnabled = true;
+AllocStats currentAllocStats() { return threadAllocStats; }
+#else
+const bool allocProfilingEnabled = false;
+AllocStats currentAllocStats() { return {}; }
+#endif
+
+// Allocations made on this thread since 'start' was taken
+AllocStats allocsSince(const AllocStats& start) {
+    AllocStats now = currentAllocStats();
+    return {now.count - start.count, now.bytes - start.bytes};
+}
+
+// Formats a per-op allocation figure, or "n/a" when profiling is compiled out
+string allocsPerOp(unsigned long long total, size_t ops) {
+    if (!allocProfilingEnabled) return "n/a";
+    stringstream ss;
+    ss << fixed << setprecision(1) << (ops ? static_cast<double>(total) / ops : 0.0);
+    return ss.str();
+}
+
+// --- Memory Accounting (per-subsystem counters) ---
+// Containers and heap objects are tagged with the subsystem that owns them so the
+// admin stats view can report live bytes per subsystem. Only container/object
+// storage is counted; short strings live inline (SSO) inside those blocks.
+enum class MemTag { Trains, SeatMaps, Bookings, Passengers, Waitlists, Users, Indexes, Count };
+
+struct MemCounter {
+    atomic<long long> liveBytes{0};
+    atomic<long long> liveBlocks{0};
+};
+
+MemCounter memCounters[static_cast<int>(MemTag::Count)];
+
+const char* memTagName(MemTag tag) {
+    switch (tag) {
+        case MemTag::Trains: return "Trains";
+        case MemTag::SeatMaps: return "Seat Maps";
+        case MemTag::Bookings: return "Bookings";
+        case MemTag::Passengers: return "Passengers";
+        case MemTag::Waitlists: return "Waitlists";
+        case MemTag::Users: return "Users";
+        case MemTag::Indexes: return "Indexes";
+        default: return "Unknown";
+    }
+}
+
+void memTrackAlloc(MemTag tag, size_t bytes) {
+    memCounters[static_cast<int>(tag)].liveBytes += static_cast<long long>(bytes);
+    memCounters[static_cast<int>(tag)].liveBlocks++;
+}
+
+void memTrackFree(MemTag tag, size_t bytes) {
+    memCounters[static_cast<int>(tag)].liveBytes -= static_cast<long long>(bytes);
+    memCounters[static_cast<int>(tag)].liveBlocks--;
+}
+
+// Counting allocator: behaves like std::allocator but charges the owning subsystem
+template <typename T, MemTag Tag>
+struct TaggedAllocator {
+    using value_type = T;
+    template <typename U> struct rebind { using other = TaggedAllocator<U, Tag>; };
+
+    TaggedAllocator() noexcept {}
+    template <typename U> TaggedAllocator(const TaggedAllocator<U, Tag>&) noexcept {}
+
+    T* allocate(size_t n) {
+        memTrackAlloc(Tag, n * sizeof(T));
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    void deallocate(T* p, size_t n) noexcept {
+        memTrackFree(Tag, n * sizeof(T));
+        ::operator delete(p);
+    }
+
+    template <typename U> bool operator==(const TaggedAllocator<U, Tag>&) const noexcept { return true; }
+    template <typename U> bool operator!=(const TaggedAllocator<U, Tag>&) const noexcept { return false; }
+};
+
+// --- Money (Fixed-Point Paise) ---
+// Every fare, refund and revenue figure is a whole number of paise in an int64, so sums
+// are exact and formatting/parsing is integer work. Fractional multipliers (pricing,
+// concessions) are applied with scaled(), which rounds to the nearest paisa once.
+class Money {
+private:
+    int64_t paise;
+    explicit constexpr Money(int64_t p) : paise(p) {}
+
+public:
+    constexpr Money() : paise(0) {}
+    static constexpr Money fromPaise(int64_t p) { return Money(p); }
+
+    int64_t toPaise() const { return paise; }
+
+    Money operator+(Money o) const { return Money(paise + o.paise); }
+    Money operator-(Money o) const { return Money(paise - o.paise); }
+    Money& operator+=(Money o) { paise += o.paise; return *this; }
+    Money& operator-=(Money o) { paise -= o.paise; return *this; }
+    Money operator*(int64_t n) const { return Money(paise * n); }
+    Money scaled(double multiplier) const { return Money(llround(static_cast<double>(paise) * multiplier)); }
+    // pct% of the amount, rounded half away from zero (e.g. refunds)
+    Money percent(int pct) const {
+        int64_t scaledPaise = paise * pct;
+        return Money((scaledPaise + (scaledPaise < 0 ? -50 : 50)) / 100);
+    }
+
+    bool operator==(Money o) const { return paise == o.paise; }
+    bool operator!=(Money o) const { return paise != o.paise; }
+    bool operator<(Money o) const { return paise < o.paise; }
+    bool operator>(Money o) const { return paise > o.paise; }
+    bool operator<=(Money o) const { return paise <= o.paise; }
+    bool operator>=(Money o) const { return paise >= o.paise; }
+
+    // Writes "-1234.50" at 'first' (needs 24 bytes) and returns the end pointer
+    char* format(char* first) const {
+        uint64_t magnitude = paise < 0 ? 0 - static_cast<uint64_t>(paise) : static_cast<uint64_t>(paise);
+        if (paise < 0) *first++ = '-';
+        first = to_chars(first, first + 21, magnitude / 100).ptr;
+        *first++ = '.';
+        *first++ = static_cast<char>('0' + (magnitude / 10) % 10);
+        *first++ = static_cast<char>('0' + magnitude % 10);
+        return first;
+    }
+
+    string toString() const {
+        char digits[24];
+        return string(digits, format(digits));
+    }
+
+    // Accepts "1234", "1234.5", "1234.50" and the old to_string form "1234.500000"
+    // (digits past the paisa are rounded). Returns false on anything else.
+    static bool parse(string_view text, Money& out) {
+        bool negative = !text.empty() && text.front() == '-';
+        if (negative) text.remove_prefix(1);
+        size_t dot = text.find('.');
+        string_view whole = text.substr(0, dot);
+        if (whole.empty()) return false;
+        uint64_t rupees = 0;
+        auto res = from_chars(whole.data(), whole.data() + whole.size(), rupees);
+        if (res.ec != errc() || res.ptr != whole.data() + whole.size()) return false;
+
+        uint64_t fraction = 0;
+        if (dot != string_view::npos) {
+            string_view frac = text.substr(dot + 1);
+            for (size_t i = 0; i < frac.size(); ++i) {
+                if (frac[i] < '0' || frac[i] > '9') return false;
+                if (i < 2) fraction = fraction * 10 + static_cast<uint64_t>(frac[i] - '0');
+            }
+            if (frac.size() == 1) fraction *= 10;
+            if (frac.size() > 2 && frac[2] >= '5') fraction++;
+        }
+        int64_t total = static_cast<int64_t>(rupees * 100 + fraction);
+        out = Money(negative ? -total : total);
+        return true;
+    }
+
+    // parse() that throws like stod, for the try/catch deserializers
+    static Money parseOrThrow(const string& text) {
+        Money m;
+        if (!parse(text, m)) throw invalid_argument("bad amount '" + text + "'");
+        return m;
+    }
+};
+
+ostream& operator<<(ostream& os, Money m) {
+    char digits[24];
+    return os.write(digits, m.format(digits) - digits);
+}
+
+// --- Report Rendering Buffer ---
+// Reports are rendered into a large reusable buffer and written to the console (or any
+// sink stream) in big chunks, instead of 'cout << ... << endl' flushing every line.
+// Numbers are formatted with to_chars and an integer fixed-point path.
+class ReportBuffer {
+private:
+    string buffer;
+    size_t flushThreshold; // 0 = never write to the sink on its own
+    ostream* sink;
+
+    ReportBuffer& maybeFlush() {
+        if (flushThreshold != 0 && buffer.size() >= flushThreshold) {
+            sink->write(buffer.data(), static_cast<streamsize>(buffer.size()));
+            buffer.clear();
+        }
+        return *this;
+    }
+
+public:
+    explicit ReportBuffer(size_t threshold = 0, ostream& out = cout, size_t reserveBytes = 4096)
+        : flushThreshold(threshold), sink(&out) {
+        buffer.reserve(max(reserveBytes, threshold + 4096));
+    }
+
+    // Shared per-thread console buffer (64 KB chunks)
+    static ReportBuffer& console() {
+        thread_local ReportBuffer instance(64 * 1024);
+        return instance;
+    }
+
+    ReportBuffer& operator<<(const string& s) { buffer += s; return maybeFlush(); }
+    ReportBuffer& operator<<(const char* s) { buffer += s; return maybeFlush(); }
+    ReportBuffer& operator<<(char c) { buffer += c; return maybeFlush(); }
+
+    template <typename T>
+    typename enable_if<is_integral<T>::value && !is_same<T, char>::value && !is_same<T, bool>::value, ReportBuffer&>::type
+    operator<<(T value) {
+        char digits[24];
+        auto res = to_chars(digits, digits + sizeof(digits), value);
+        buffer.append(digits, res.ptr);
+        return maybeFlush();
+    }
+
+    // Fixed-point with two decimals (replaces fixed << setprecision(2))
+    ReportBuffer& fixed2(double value) {
+        long long cents = llround(value * 100.0);
+        if (cents < 0) { buffer += '-'; cents = -cents; }
+        *this << (cents / 100);
+        buffer += '.';
+        buffer += static_cast<char>('0' + (cents / 10) % 10);
+        buffer += static_cast<char>('0' + cents % 10);
+        return maybeFlush();
+    }
+
+    // Left-aligned field padded to 'width' bytes (replaces left << setw(width))
+    ReportBuffer& field(const string& s, size_t width) {
+        buffer += s;
+        if (s.size() < width) buffer.append(width - s.size(), ' ');
+        return maybeFlush();
+    }
+
+    template <typename T>
+    ReportBuffer& field(T value, size_t width) {
+        size_t start = buffer.size();
+        *this << value;
+        size_t written = buffer.size() - start;
+        if (written < width) buffer.append(width - written, ' ');
+        return maybeFlush();
+    }
+
+    ReportBuffer& operator<<(Money m) {
+        char digits[24];
+        buffer.append(digits, m.format(digits));
+        return maybeFlush();
+    }
+    ReportBuffer& fixed2(Money m) { return *this << m; }
+
+    ReportBuffer& fixed2Field(Money m, size_t width) {
+        size_t start = buffer.size();
+        *this << m;
+        size_t written = buffer.size() - start;
+        if (written < width) buffer.append(width - written, ' ');
+        return maybeFlush();
+    }
+
+    ReportBuffer& fixed2Field(double value, size_t width) {
+        size_t start = buffer.size();
+        fixed2(value);
+        size_t written = buffer.size() - start;
+        if (written < width) buffer.append(width - written, ' ');
+        return maybeFlush();
+    }
+
+    void append(const ReportBuffer& other) { buffer += other.buffer; maybeFlush(); }
+    const string& str() const { return buffer; }
+    size_t size() const { return buffer.size(); }
+    void clear() { buffer.clear(); }
+
+    // Write everything rendered so far and flush the stream once
+    void flush() {
+        sink->write(buffer.data(), static_cast<streamsize>(buffer.size()));
+        sink->flush();
+        buffer.clear();
+    }
+};
+
+// Renders rows [0, count) with renderRow(buffer, index) on all cores: each thread formats
+// a contiguous partition into its own buffer and partitions are appended to 'out' in
+// order. Work proceeds in rounds of rowsPerPartition per thread so memory stays bounded.
+template <typename RenderRow>
+void renderRowsParallel(ReportBuffer& out, size_t count, RenderRow renderRow,
+                        size_t minParallelRows = 4096, size_t rowsPerPartition = 16384) {
+    unsigned threads = max(1u, thread::hardware_concurrency());
+    if (threads == 1 || count < minParallelRows) {
+        for (size_t i = 0; i < count; ++i) renderRow(out, i);
+        return;
+    }
+
+    vector<ReportBuffer> partitions(threads);
+    const size_t roundRows = threads * rowsPerPartition;
+    for (size_t roundStart = 0; roundStart < count; roundStart += roundRows) {
+        size_t roundCount = min(count - roundStart, roundRows);
+        auto work = [&](unsigned t) {
+            size_t begin = roundStart + roundCount * t / threads;
+            size_t end = roundStart + roundCount * (t + 1) / threads;
+            for (size_t i = begin; i < end; ++i) renderRow(partitions[t], i);
+        };
+        vector<thread> workers;
+        for (unsigned t = 1; t < threads; ++t) workers.emplace_back(work, t);
+        work(0);
+        for (auto& w : workers) w.join();
+        for (auto& partition : partitions) {
+            out.append(partition);
+            partition.clear();
+        }
+    }
+}
+
+// Export field encoders: RFC 4180 CSV quoting and JSON string escaping
+ReportBuffer& csvField(ReportBuffer& out, const string& value) {
+    if (value.find_first_of(",\"\r\n") == string::npos) return out << value;
+    out << '"';
+    for (char c : value) {
+        if (c == '"') out << '"';
+        out << c;
+    }
+    return out << '"';
+}
+
+ReportBuffer& jsonString(ReportBuffer& out, const string& value) {
+    out << '"';
+    for (char c : value) {
+        switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\r': out << "\\r"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    const char* hexDigits = "0123456789abcdef";
+                    out << "\\u00" << hexDigits[(c >> 4) & 0xF] << hexDigits[c & 0xF];
+                } else {
+                    out << c;
+                }
+        }
+    }
+    return out << '"';
+}
+
+// --- Deterministic Replay: InputCapture ---
+// Records every external input to RailwayManager (requests, payment outcomes, wall
+// clock) as tab-separated records so a run can be replayed exactly:
+//   RMCAPTURE	1 / BEGIN	<digest> / T	<epoch> / D	<epoch> / BOOK	... / PAY	1 / ... / END	<digest>
+// D records are the calendar-day clock of Date::today(), written only when the day changes.
+class InputCapture {
+private:
+    ofstream captureFile;
+    vector<vector<string>> replayRecords;
+    size_t replayCursor = 0;
+    bool replaying = false;
+    time_t replayTime = 0;
+    time_t dayWindowStart = 0, dayWindowEnd = 0; // See dayClock()
+
+    InputCapture() {}
+
+    // Next replay record if it has the given tag, otherwise nullptr (cursor unchanged)
+    const vector<string>* peekTag(const string& tag) const {
+        if (replayCursor < replayRecords.size() && !replayRecords[replayCursor].empty() &&
+            replayRecords[replayCursor][0] == tag) {
+            return &replayRecords[replayCursor];
+        }
+        return nullptr;
+    }
+
+public:
+    InputCapture(const InputCapture&) = delete;
+    InputCapture& operator=(const InputCapture&) = delete;
+
+    static InputCapture& getInstance() {
+        static InputCapture instance;
+        return instance;
+    }
+
+    static vector<string> splitRecord(const string& line) {
+        vector<string> fields;
+        stringstream ss(line);
+        string field;
+        while (getline(ss, field, '\t')) {
+            fields.push_back(field);
+        }
+        return fields;
+    }
+
+    bool isCapturing() const { return captureFile.is_open(); }
+    bool isReplaying() const { return replaying; }
+
+    // --- Capture side ---
+    bool beginCapture(const string& path, const string& stateDigest) {
+        captureFile.open(path, ios::trunc);
+        if (!captureFile.is_open()) return false;
+        captureFile << "RMCAPTURE\t1\n";
+        setDayWindow(0, 0); // The first day read of the capture is recorded
+        record({"BEGIN", stateDigest});
+        return true;
+    }
+
+    void endCapture(const string& stateDigest) {
+        if (!isCapturing()) return;
+        record({"END", stateDigest});
+        captureFile.close();
+    }
+
+    void record(const vector<string>& fields) {
+        if (!isCapturing()) return;
+        for (size_t i = 0; i < fields.size(); ++i) {
+            captureFile << (i ? "\t" : "") << fields[i];
+        }
+        captureFile << "\n";
+        captureFile.flush(); // Capture must survive a crash
+    }
+
+    // Wall clock as seen by the system; captured or replayed
+    time_t now() {
+        if (replaying) {
+            if (const vector<string>* rec = peekTag("T")) {
+                if (rec->size() == 2) replayTime = static_cast<time_t>(stoll((*rec)[1]));
+                replayCursor++;
+            }
+            return replayTime;
+        }
+        time_t t = time(0);
+        record({"T", to_string(static_cast<long long>(t))});
+        return t;
+    }
+
+    // Clock for Date::today(): true with 't' set when the cached day has to be recomputed,
+    // i.e. the clock left [dayWindowStart, dayWindowEnd). Only those day changes are recorded
+    // ('D'), so fare quotes and searches that ask for today many times per request do not
+    // write a clock record each. The window is reset when a capture or replay starts.
+    bool dayClock(time_t& t) {
+        if (replaying) {
+            if (const vector<string>* rec = peekTag("D")) {
+                if (rec->size() == 2) replayTime = static_cast<time_t>(stoll((*rec)[1]));
+                replayCursor++;
+            } else if (dayWindowEnd != 0) {
+                return false; // The captured run stayed on the same day here
+            }
+            t = replayTime; // Captures without D records: the last T record
+            return true;
+        }
+        t = time(0);
+        if (t >= dayWindowStart && t < dayWindowEnd) return false;
+        record({"D", to_string(static_cast<long long>(t))});
+        return true;
+    }
+
+    void setDayWindow(time_t start, time_t end) {
+        dayWindowStart = start;
+        dayWindowEnd = end;
+    }
+
+    // Payment outcome: live result when capturing, recorded result when replaying
+    bool resolvePayment(bool liveOutcome) {
+        if (replaying) {
+            bool outcome = false;
+            if (const vector<string>* rec = peekTag("PAY")) {
+                outcome = (rec->size() == 2 && (*rec)[1] == "1");
+                replayCursor++;
+            } else {
+                cerr << "[Replay] Missing PAY record at " << replayCursor << ". Assuming failure." << endl;
+            }
+            return outcome;
+        }
+        record({"PAY", liveOutcome ? "1" : "0"});
+        return liveOutcome;
+    }
+
+    // --- Replay side ---
+    bool loadReplay(const string& path) {
+        ifstream in(path);
+        string line;
+        if (!getline(in, line) || splitRecord(line) != vector<string>{"RMCAPTURE", "1"}) {
+            return false;
+        }
+        replayRecords.clear();
+        while (getline(in, line)) {
+            if (!line.empty()) replayRecords.push_back(splitRecord(line));
+        }
+        replayCursor = 0;
+        replaying = true;
+        setDayWindow(0, 0);
+        return true;
+    }
+
+    // Next unconsumed record for the replay driver, or nullptr at end of capture
+    const vector<string>* nextRecord() {
+        if (replayCursor >= replayRecords.size()) return nullptr;
+        return &replayRecords[replayCursor++];
+    }
+
+    void setReplayTime(time_t t) { replayTime = t; }
+    void endReplay() {
+        replaying = false;
+        setDayWindow(0, 0); // Back on the live clock
+    }
+};
+
+// --- Versioned Data Files (Schema-Described Records) ---
+// Layout of trains_data.txt, bookings_data.txt and users_data.txt from version 2 on:
+//   RMDATA|<version>|<kind>             header line
+//   #SCHEMA|<TAG>|field|field|...       field names of one record type, before its records
+//   <TAG>|value|value|...               one record per line, values in schema order
+// Values escape '\' and '|' (and newlines) with a backslash, so a field may carry nested
+// '|' data such as a seat map. Readers look fields up by name: fields they do not know
+// are skipped and fields the file lacks read as empty. Files without a header are the
+// positional version-1 layouts; DataFileMigrator upgrades them in one streaming pass.
+const int DATA_FILE_VERSION = 2;
+
+void appendEscapedField(string& out, string_view value) {
+    for (char c : value) {
+        if (c == '\n') {
+            out += "\\n";
+            continue;
+        }
+        if (c == '\\' || c == '|') out += '\\';
+        out += c;
+    }
+}
+
+// TAG|escaped|escaped|...
+string formatRecord(const string& tag, const vector<string>& values) {
+    string line = tag;
+    for (const auto& value : values) {
+        line += '|';
+        appendEscapedField(line, value);
+    }
+    return line;
+}
+
+// Splits on unescaped '|' and unescapes in the same pass; 'fields' is reused across lines
+void splitRecordFields(string_view line, vector<string>& fields) {
+    size_t count = 0;
+    auto nextField = [&fields, &count]() -> string& {
+        if (count == fields.size()) fields.emplace_back();
+        string& field = fields[count++];
+        field.clear();
+        return field;
+    };
+    string* field = &nextField();
+    for (size_t i = 0; i < line.size(); ++i) {
+        char c = line[i];
+        if (c == '\\' && i + 1 < line.size()) {
+            char escaped = line[++i];
+            *field += (escaped == 'n') ? '\n' : escaped;
+        } else if (c == '|') {
+            field = &nextField();
+        } else {
+            *field += c;
+        }
+    }
+    fields.resize(count);
+}
+
+struct DataRecord {
+    vector<string> fields;                 // fields[0] is the record tag
+    const vector<string>* names = nullptr; // Schema names for fields[1..]; null if undeclared
+
+    const string& tag() const { return fields[0]; }
+
+    // Value of the named field, or "" if this file's schema does not have it
+    const string& get(string_view name) const {
+        static const string missing;
+        if (!names) return missing;
+        for (size_t i = 0; i < names->size(); ++i) {
+            if ((*names)[i] == name) return i + 1 < fields.size() ? fields[i + 1] : missing;
+        }
+        return missing;
+    }
+};
+
+class RecordWriter {
+private:
+    ostream& out;
+
+public:
+    RecordWriter(ostream& stream, const string& kind) : out(stream) {
+        out << "RMDATA|" << DATA_FILE_VERSION << "|" << kind << "\n";
+    }
+
+    void schema(const string& tag, const vector<string>& names) {
+        out << formatRecord("#SCHEMA|" + tag, names) << "\n";
+    }
+
+    void write(const string& tag, const vector<string>& values) {
+        out << formatRecord(tag, values) << '\n';
+    }
+};
+
+class RecordReader {
+private:
+    istream& in;
+    int version = 0; // 0 = empty file, 1 = legacy (no header)
+    string kind;
+    unordered_map<string, vector<string>> schemas;
+    string line;
+    bool pendingLine = false; // Legacy files: the first line was read while probing
+    size_t bytesRead = 0;
+    size_t recordOffset = 0; // Byte offset of the line last returned by next()
+
+public:
+    explicit RecordReader(istream& stream) : in(stream) {
+        if (!getline(in, line)) return;
+        bytesRead += line.size() + 1;
+        vector<string> header;
+        splitRecordFields(line, header);
+        if (header.size() >= 3 && header[0] == "RMDATA") {
+            try {
+                version = stoi(header[1]);
+            } catch (const std::exception&) {
+                version = DATA_FILE_VERSION;
+            }
+            kind = header[2];
+        } else {
+            version = 1;
+            pendingLine = true;
+        }
+    }
+
+    int getVersion() const { return version; }
+    const string& getKind() const { return kind; }
+    bool isLegacy() const { return version == 1; }
+    size_t getBytesRead() const { return bytesRead; }
+    size_t getRecordOffset() const { return recordOffset; }
+
+    // Raw lines of a version-1 file
+    bool nextLine(string& out) {
+        if (pendingLine) {
+            pendingLine = false;
+            out = line;
+            return true;
+        }
+        if (!getline(in, out)) return false;
+        bytesRead += out.size() + 1;
+        return true;
+    }
+
+    // Next data record; #SCHEMA lines are absorbed on the way
+    bool next(DataRecord& record) {
+        while (getline(in, line)) {
+            bytesRead += line.size() + 1;
+            if (line.empty()) continue;
+            splitRecordFields(line, record.fields);
+            if (record.fields[0] == "#SCHEMA") {
+                if (record.fields.size() >= 2) {
+                    schemas[record.fields[1]].assign(record.fields.begin() + 2, record.fields.end());
+                }
+                continue;
+            }
+            auto it = schemas.find(record.fields[0]);
+            record.names = (it != schemas.end()) ? &it->second : nullptr;
+            recordOffset = bytesRead - line.size() - 1;
+            return true;
+        }
+        return false;
+    }
+};
+
 // --- 1. Passenger Class (Encapsulation) ---
 class Passenger {
 private:
@@ -61,516 +926,2607 @@ public:
     // Default Constructor (required for vector operations)
     Passenger() : name(""), age(0), gender("") {}
 
-    // Getters
-    string getName() const { return name; }
-    int getAge() const { return age; }
-    string getGender() const { return gender; }
+    // Getters
+    string getName() const { return name; }
+    int getAge() const { return age; }
+    string getGender() const { return gender; }
+
+    // Display
+    void displayPassenger(ReportBuffer& out = ReportBuffer::console()) const {
+        out << "    Name: " << name << ", Age: " << age 
+            << ", Gender: " << gender << '\n';
+    }
+
+    // Serialization for File Persistence
+    string serialize() const {
+        // Format: Name|Age|Gender
+        return name + "|" + to_string(age) + "|" + gender;
+    }
+};
+
+// --- NEW ENUM 2a: CoachClass ---
+// Sleeper, AC 3-tier, AC 2-tier and AC First. Every train offers a subset of these,
+// each with its own capacity and base fare.
+enum CoachClass : uint8_t { CLASS_SL, CLASS_3A, CLASS_2A, CLASS_1A, CLASS_COUNT };
+
+const char* coachClassName(int cls) {
+    static const char* const names[CLASS_COUNT] = {"SL", "3A", "2A", "1A"};
+    return (cls >= 0 && cls < CLASS_COUNT) ? names[cls] : "?";
+}
+
+bool parseCoachClass(const string& name, int& cls) {
+    for (int c = 0; c < CLASS_COUNT; ++c) {
+        if (name == coachClassName(c)) {
+            cls = c;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Pricing versions come from one process-wide counter, so a seat block that is created
+// again (a train removed and re-added, a day pruned and re-opened) never reuses a version
+// that a cached fare quote was stored under. 0 is never issued.
+uint32_t nextPricingVersion() {
+    static atomic<uint32_t> counter{0};
+    return ++counter;
+}
+
+// --- 2. SeatAllocation Structure (Data Management) ---
+// One block per (train, date) with every class's availability side by side, so a
+// single read answers "what's left on this train today". Only the hot availability
+// data lives here; the derived fare cache is kept in a parallel FareCache array.
+struct SeatAllocation {
+    Date date;
+    int32_t available[CLASS_COUNT] = {}; // Seats left per CoachClass
+    bool chartPrepared = false; // Inventory frozen once the reservation chart is out
+
+    int totalAvailable() const {
+        int total = 0;
+        for (int c = 0; c < CLASS_COUNT; ++c) total += available[c];
+        return total;
+    }
+
+    string serialize() const {
+        // Format: Date|SL[,3A[,2A[,1A]]], with a trailing |C once the chart is prepared.
+        // Trailing zero classes are dropped, so single-class trains keep the old Date|Seats form.
+        int last = CLASS_COUNT - 1;
+        while (last > 0 && available[last] == 0) last--;
+        string data = date.toString() + "|";
+        for (int c = 0; c <= last; ++c) data += (c ? "," : "") + to_string(available[c]);
+        return data + (chartPrepared ? "|C" : "");
+    }
+    
+    static SeatAllocation deserialize(const string& data) {
+        stringstream ss(data);
+        string segment;
+        vector<string> parts;
+        while (getline(ss, segment, '|')) {
+            parts.push_back(segment);
+        }
+        SeatAllocation alloc;
+        try {
+            if (parts.size() == 2 || parts.size() == 3) {
+                if (!Date::parse(parts[0], alloc.date)) throw invalid_argument("bad date '" + parts[0] + "'");
+                stringstream counts(parts[1]);
+                string count;
+                for (int c = 0; c < CLASS_COUNT && getline(counts, count, ','); ++c) alloc.available[c] = stoi(count);
+                alloc.chartPrepared = (parts.size() == 3 && parts[2] == "C");
+                return alloc;
+            }
+        } catch (const std::exception& e) {
+            cerr << "[Error] SeatAllocation deserialization failed: " << e.what() << endl;
+        }
+        return SeatAllocation(); // Error case
+    }
+};
+
+static_assert(sizeof(SeatAllocation) <= 64, "SeatAllocation must fit in one cache line");
+
+// Live price cache for one seat block (derived, not persisted): current fare-ladder step
+// and the per-passenger fare per class computed for it on day 'pricedDay' (-1 = stale).
+// Only pricing reads it, so availability scans never pull these bytes in.
+struct FareCache {
+    int32_t fareStep = 0;
+    int32_t pricedDay = -1; // Date::dayNumber of the pricing day
+    uint32_t pricingVersion = nextPricingVersion(); // Renewed whenever the price for this train-date may change
+    Money liveFare[CLASS_COUNT] = {};
+};
+
+using SeatMapStore = vector<SeatAllocation, TaggedAllocator<SeatAllocation, MemTag::SeatMaps>>;
+using FareCacheStore = vector<FareCache, TaggedAllocator<FareCache, MemTag::SeatMaps>>;
+
+// Contiguous run of one train's blocks (or their fare caches) inside the fleet-wide arrays
+template <typename T>
+struct BlockRange {
+    T* first;
+    T* last;
+    T* begin() const { return first; }
+    T* end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+};
+
+// --- NEW CLASS 2a: SeatInventory (Fleet-Wide Seat Blocks) ---
+// Every train's seat blocks live in three parallel fleet-wide arrays sorted by (train slot,
+// date): a packed 64-bit key per block for the binary search, the SeatAllocation blocks and
+// their FareCache. Each train owns one slot, so its blocks are one contiguous run, and a
+// lookup searches 8-byte keys instead of chasing a per-train vector. Slots are never reused
+// and a new train's slot sorts last, so adding a train appends.
+class SeatInventory {
+private:
+    vector<uint64_t, TaggedAllocator<uint64_t, MemTag::SeatMaps>> keys;
+    SeatMapStore blocks;
+    FareCacheStore fares;
+    uint32_t nextSlot = 0;
+    SeatInventory() {}
+
+    // Day numbers are signed; flipping the sign bit keeps them in order as unsigned
+    static uint64_t keyOf(uint32_t slot, Date day) {
+        return (static_cast<uint64_t>(slot) << 32) | (static_cast<uint32_t>(day.dayNumber()) ^ 0x80000000u);
+    }
+
+    size_t lowerBound(uint64_t key) const {
+        return static_cast<size_t>(lower_bound(keys.begin(), keys.end(), key) - keys.begin());
+    }
+
+    pair<size_t, size_t> span(uint32_t slot) const {
+        return {lowerBound(static_cast<uint64_t>(slot) << 32), lowerBound(static_cast<uint64_t>(slot + 1) << 32)};
+    }
+
+    void eraseSpan(size_t from, size_t to) {
+        keys.erase(keys.begin() + from, keys.begin() + to);
+        blocks.erase(blocks.begin() + from, blocks.begin() + to);
+        fares.erase(fares.begin() + from, fares.begin() + to);
+    }
+
+public:
+    static SeatInventory& getInstance() {
+        static SeatInventory instance;
+        return instance;
+    }
+
+    uint32_t acquireSlot() { return nextSlot++; }
+
+    // Drops every block of 'slot'
+    void release(uint32_t slot) {
+        auto range = span(slot);
+        eraseSpan(range.first, range.second);
+    }
+
+    // Replaces the blocks of 'slot' with 'sorted' (ascending, unique dates); fare caches start stale
+    void assign(uint32_t slot, const vector<SeatAllocation>& sorted) {
+        auto range = span(slot);
+        eraseSpan(range.first, range.second);
+        size_t at = range.first;
+        keys.insert(keys.begin() + at, sorted.size(), 0);
+        for (size_t i = 0; i < sorted.size(); ++i) keys[at + i] = keyOf(slot, sorted[i].date);
+        blocks.insert(blocks.begin() + at, sorted.begin(), sorted.end());
+        fares.insert(fares.begin() + at, sorted.size(), FareCache());
+        for (size_t i = 0; i < sorted.size(); ++i) fares[at + i] = FareCache(); // Each gets its own version
+    }
+
+    // Copies the blocks and fare caches of 'from' into the empty slot 'to'
+    void copySlot(uint32_t from, uint32_t to) {
+        auto range = span(from);
+        vector<SeatAllocation> copiedBlocks(blocks.begin() + range.first, blocks.begin() + range.second);
+        vector<FareCache> copiedFares(fares.begin() + range.first, fares.begin() + range.second);
+        size_t at = span(to).first;
+        keys.insert(keys.begin() + at, copiedBlocks.size(), 0);
+        for (size_t i = 0; i < copiedBlocks.size(); ++i) keys[at + i] = keyOf(to, copiedBlocks[i].date);
+        blocks.insert(blocks.begin() + at, copiedBlocks.begin(), copiedBlocks.end());
+        fares.insert(fares.begin() + at, copiedFares.begin(), copiedFares.end());
+    }
+
+    SeatAllocation* find(uint32_t slot, Date day) {
+        uint64_t key = keyOf(slot, day);
+        size_t i = lowerBound(key);
+        return (i < keys.size() && keys[i] == key) ? &blocks[i] : nullptr;
+    }
+    const SeatAllocation* find(uint32_t slot, Date day) const {
+        return const_cast<SeatInventory*>(this)->find(slot, day);
+    }
+
+    // Block for (slot, day), inserted from 'fresh' if missing
+    SeatAllocation& findOrInsert(uint32_t slot, Date day, const SeatAllocation& fresh) {
+        uint64_t key = keyOf(slot, day);
+        size_t i = lowerBound(key);
+        if (i == keys.size() || keys[i] != key) {
+            keys.insert(keys.begin() + i, key);
+            blocks.insert(blocks.begin() + i, fresh);
+            fares.insert(fares.begin() + i, FareCache());
+        }
+        return blocks[i];
+    }
+
+    // Drops the blocks of 'slot' that 'drop' accepts
+    template <typename Predicate>
+    void eraseIf(uint32_t slot, Predicate drop) {
+        auto range = span(slot);
+        size_t kept = range.first;
+        for (size_t i = range.first; i < range.second; ++i) {
+            if (drop(blocks[i])) continue;
+            keys[kept] = keys[i];
+            blocks[kept] = blocks[i];
+            fares[kept] = fares[i];
+            kept++;
+        }
+        eraseSpan(kept, range.second);
+    }
+
+    FareCache& faresOf(const SeatAllocation& alloc) { return fares[&alloc - blocks.data()]; }
+    const FareCache& faresOf(const SeatAllocation& alloc) const { return fares[&alloc - blocks.data()]; }
+
+    BlockRange<SeatAllocation> blocksOf(uint32_t slot) {
+        auto range = span(slot);
+        return {blocks.data() + range.first, blocks.data() + range.second};
+    }
+    BlockRange<const SeatAllocation> blocksOf(uint32_t slot) const {
+        auto range = span(slot);
+        return {blocks.data() + range.first, blocks.data() + range.second};
+    }
+    BlockRange<FareCache> faresOf(uint32_t slot) {
+        auto range = span(slot);
+        return {fares.data() + range.first, fares.data() + range.second};
+    }
+};
+
+// A train's SeatInventory slot. Copies clone the blocks into a fresh slot, moves hand the
+// slot over, and destruction (a removed train included) releases its blocks.
+class InventorySlot {
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+    uint32_t id;
+
+public:
+    InventorySlot() : id(SeatInventory::getInstance().acquireSlot()) {}
+    InventorySlot(const InventorySlot& other) : InventorySlot() { SeatInventory::getInstance().copySlot(other.id, id); }
+    InventorySlot(InventorySlot&& other) noexcept : id(other.id) { other.id = NONE; }
+    InventorySlot& operator=(const InventorySlot& other) {
+        if (this != &other) {
+            if (id == NONE) id = SeatInventory::getInstance().acquireSlot();
+            SeatInventory::getInstance().release(id);
+            SeatInventory::getInstance().copySlot(other.id, id);
+        }
+        return *this;
+    }
+    InventorySlot& operator=(InventorySlot&& other) noexcept {
+        if (this != &other) {
+            if (id != NONE) SeatInventory::getInstance().release(id);
+            id = other.id;
+            other.id = NONE;
+        }
+        return *this;
+    }
+    ~InventorySlot() {
+        if (id != NONE) SeatInventory::getInstance().release(id);
+    }
+
+    uint32_t get() const { return id; }
+};
+
+// --- NEW CLASS 2b: StationRegistry (Interned Station Names) ---
+// Every station name is stored once and referred to by a dense uint32 id.
+class StationRegistry {
+private:
+    vector<string> names;
+    unordered_map<string, uint32_t> ids;
+    StationRegistry() {}
+
+public:
+    static StationRegistry& getInstance() {
+        static StationRegistry instance;
+        return instance;
+    }
+
+    uint32_t intern(const string& name) {
+        auto it = ids.find(name);
+        if (it != ids.end()) return it->second;
+        uint32_t id = static_cast<uint32_t>(names.size());
+        ids.emplace(name, id);
+        names.push_back(name);
+        return id;
+    }
+
+    bool find(const string& name, uint32_t& id) const {
+        auto it = ids.find(name);
+        if (it == ids.end()) return false;
+        id = it->second;
+        return true;
+    }
+
+    const string& name(uint32_t id) const { return names[id]; }
+    size_t size() const { return names.size(); }
+    void reserve(size_t count) { names.reserve(count); ids.reserve(count); }
+};
+
+// --- NEW STRUCT 3a: Stop (Schedule Detail) ---
+// Times are minutes after midnight; NO_TIME marks the origin's arrival/terminus departure
+const int16_t NO_TIME = -1;
+
+struct Stop {
+    uint32_t stationId;
+    int16_t arrivalMin;
+    int16_t departureMin;
+
+    bool operator==(const Stop& o) const {
+        return stationId == o.stationId && arrivalMin == o.arrivalMin && departureMin == o.departureMin;
+    }
+};
+
+using Timetable = vector<Stop>;
+
+// "HH:MM" (or "N/A"/"-" for NO_TIME) to minutes after midnight
+bool parseClockTime(const string& text, int16_t& minutes) {
+    if (text == "N/A" || text == "-") {
+        minutes = NO_TIME;
+        return true;
+    }
+    int h, m;
+    char colon;
+    stringstream ss(text);
+    if (!(ss >> h >> colon >> m) || colon != ':' || h < 0 || h > 23 || m < 0 || m > 59) return false;
+    minutes = static_cast<int16_t>(h * 60 + m);
+    return true;
+}
+
+string formatClockTime(int16_t minutes) {
+    if (minutes == NO_TIME) return "N/A";
+    char text[16];
+    snprintf(text, sizeof(text), "%02d:%02d", minutes / 60, minutes % 60);
+    return text;
+}
+
+// --- NEW CLASS 3a1: TimetablePool (Shared Stop Lists) ---
+// Identical stop lists are stored once; trains running the same path share one
+// immutable Timetable. A timetable's id is its position in the pool.
+class TimetablePool {
+private:
+    vector<shared_ptr<const Timetable>> timetables;
+    unordered_map<string, uint32_t> byEncoding;
+    TimetablePool() {}
+
+public:
+    static TimetablePool& getInstance() {
+        static TimetablePool instance;
+        return instance;
+    }
+
+    // Format: StationId,ArrMin,DepMin;... (ids from StationRegistry)
+    static string encode(const Timetable& stops) {
+        string data;
+        for (const auto& stop : stops) {
+            data += to_string(stop.stationId) + "," + to_string(stop.arrivalMin) + "," + to_string(stop.departureMin) + ";";
+        }
+        return data;
+    }
+
+    static Timetable decode(const string& data) {
+        Timetable stops;
+        stringstream ss(data);
+        string item;
+        while (getline(ss, item, ';')) {
+            stringstream fs(item);
+            string id, arr, dep;
+            getline(fs, id, ',');
+            getline(fs, arr, ',');
+            getline(fs, dep, ',');
+            uint32_t stationId = static_cast<uint32_t>(stoul(id));
+            if (stationId >= StationRegistry::getInstance().size()) throw out_of_range("unknown station id " + id);
+            stops.push_back({stationId, static_cast<int16_t>(stoi(arr)), static_cast<int16_t>(stoi(dep))});
+        }
+        return stops;
+    }
+
+    shared_ptr<const Timetable> intern(const Timetable& stops, uint32_t* idOut = nullptr) {
+        string key = encode(stops);
+        auto it = byEncoding.find(key);
+        uint32_t id;
+        if (it != byEncoding.end()) {
+            id = it->second;
+        } else {
+            id = static_cast<uint32_t>(timetables.size());
+            timetables.push_back(make_shared<const Timetable>(stops));
+            byEncoding.emplace(move(key), id);
+        }
+        if (idOut) *idOut = id;
+        return timetables[id];
+    }
+
+    uint32_t idOf(const shared_ptr<const Timetable>& timetable) {
+        uint32_t id;
+        intern(*timetable, &id);
+        return id;
+    }
+
+    const vector<shared_ptr<const Timetable>>& all() const { return timetables; }
+};
+
+// --- NEW CLASS 3b: Route (Schedule/Timetable Abstraction) ---
+class Route {
+private:
+    string sourceStation;
+    string destinationStation;
+    shared_ptr<const Timetable> schedule; // Shared with every train on the same stop list
+
+public:
+    // Endpoints only (times unknown) until a real timetable is supplied
+    Route(const string& src, const string& dest)
+        : sourceStation(src), destinationStation(dest) {
+        StationRegistry& stations = StationRegistry::getInstance();
+        schedule = TimetablePool::getInstance().intern(
+            {{stations.intern(src), NO_TIME, NO_TIME}, {stations.intern(dest), NO_TIME, NO_TIME}});
+    }
+
+    // Full stop list; the first and last stops are the source and destination
+    explicit Route(shared_ptr<const Timetable> stops)
+        : sourceStation(StationRegistry::getInstance().name(stops->front().stationId)),
+          destinationStation(StationRegistry::getInstance().name(stops->back().stationId)),
+          schedule(move(stops)) {}
+
+    string getSource() const { return sourceStation; }
+    string getDestination() const { return destinationStation; }
+    const Timetable& getStops() const { return *schedule; }
+    const shared_ptr<const Timetable>& getTimetable() const { return schedule; }
+
+    // True if the train calls at 'src' and later at 'dest' (intermediate stations count)
+    bool servesSegment(const string& src, const string& dest) const {
+        StationRegistry& stations = StationRegistry::getInstance();
+        uint32_t srcId, destId;
+        if (!stations.find(src, srcId) || !stations.find(dest, destId)) return false;
+        bool boarded = false;
+        for (const auto& stop : *schedule) {
+            if (boarded && stop.stationId == destId) return true;
+            if (stop.stationId == srcId) boarded = true;
+        }
+        return false;
+    }
+
+    void displaySchedule(ReportBuffer& out) const {
+        StationRegistry& stations = StationRegistry::getInstance();
+        out << "        Schedule:\n";
+        for(const auto& s : *schedule) {
+            out << "        - " << stations.name(s.stationId) << " | Arr: " << formatClockTime(s.arrivalMin)
+                << " | Dep: " << formatClockTime(s.departureMin) << '\n';
+        }
+    }
+
+    // Human-readable stop list "Name,Arr,Dep;..." (used by capture records)
+    string stopListText() const {
+        StationRegistry& stations = StationRegistry::getInstance();
+        string text;
+        for (const auto& stop : *schedule) {
+            text += stations.name(stop.stationId) + "," + formatClockTime(stop.arrivalMin) + "," +
+                    formatClockTime(stop.departureMin) + ";";
+        }
+        return text;
+    }
+
+    // Inverse of stopListText; throws on a malformed list or fewer than two stops
+    static Route fromStopList(const string& text) {
+        StationRegistry& stations = StationRegistry::getInstance();
+        Timetable stops;
+        stringstream ss(text);
+        string item;
+        while (getline(ss, item, ';')) {
+            stringstream fs(item);
+            string name, arr, dep;
+            getline(fs, name, ',');
+            getline(fs, arr, ',');
+            getline(fs, dep, ',');
+            Stop stop{stations.intern(name), NO_TIME, NO_TIME};
+            if (!parseClockTime(arr, stop.arrivalMin) || !parseClockTime(dep, stop.departureMin)) {
+                throw invalid_argument("bad stop '" + item + "'");
+            }
+            stops.push_back(stop);
+        }
+        if (stops.size() < 2) throw invalid_argument("a route needs at least two stops");
+        return Route(TimetablePool::getInstance().intern(stops));
+    }
+
+    // Persisted as source, destination and the id of its TIMETABLE record
+    uint32_t timetableId() const { return TimetablePool::getInstance().idOf(schedule); }
+
+    // 'fileTimetables' maps the TIMETABLE ids read from the same file; an empty id (trains
+    // saved before timetables were persisted) gives an endpoints-only route
+    static Route fromRecord(const string& src, const string& dest, const string& timetableId,
+                            const vector<shared_ptr<const Timetable>>& fileTimetables) {
+        if (timetableId.empty()) return Route(src, dest);
+        size_t id = stoul(timetableId);
+        if (id >= fileTimetables.size() || !fileTimetables[id]) throw out_of_range("unknown timetable " + to_string(id));
+        return Route(fileTimetables[id]);
+    }
+};
+
+
+// One localtime() per calendar day: the cached day is reused until the clock leaves the
+// [midnight, next midnight) window it was computed for. The window lives in InputCapture,
+// which records (and on replay restores) only the day changes. Called from the manager's
+// thread only; the parallel report renderers never price fares.
+Date Date::today() {
+    static Date cached;
+    time_t t;
+    InputCapture& clock = InputCapture::getInstance();
+    if (clock.dayClock(t)) {
+        tm local = *localtime(&t);
+        cached = fromCivil(local.tm_year + 1900, local.tm_mon + 1, local.tm_mday);
+        local.tm_hour = local.tm_min = local.tm_sec = 0;
+        local.tm_isdst = -1;
+        time_t windowStart = mktime(&local);
+        local.tm_mday += 1;
+        local.tm_isdst = -1;
+        clock.setDayWindow(windowStart, mktime(&local));
+    }
+    return cached;
+}
+
+// --- NEW STRUCT 3c: PricingRule ---
+struct PricingRule {
+    string name;
+    int32_t fromKey;    // Journey date range, YYYYMMDD inclusive
+    int32_t toKey;
+    int occLow;         // Occupancy band in percent, [occLow, occHigh)
+    int occHigh;
+    int daysLow;        // Days to departure band, inclusive
+    int daysHigh;
+    double multiplier;
+};
+
+// --- NEW CLASS 3d: PricingEngine (Compiled Dynamic Pricing) ---
+// Rules are compiled into disjoint date segments: sorted segment start keys plus a flat
+// list of the rules covering each segment. A quote binary-searches the journey date
+// (O(log rules)) and only checks that segment's occupancy/days-to-departure bands.
+// Every matching rule's multiplier applies.
+class PricingEngine {
+private:
+    vector<PricingRule> rules;
+    vector<int32_t> segmentStart;   // Sorted; segment i covers [segmentStart[i], segmentStart[i+1])
+    vector<uint32_t> segmentOffset; // segmentRules[segmentOffset[i] .. segmentOffset[i+1])
+    vector<uint16_t> segmentRules;
+    bool occupancySensitive = false; // Any rule with a narrower band than 0-100%
+
+    // Occupancy fare ladder: +stepMarkup for every stepPercent of seats sold
+    int ladderStepPercent = 0;       // 0 = no ladder
+    double ladderStepMarkup = 0.0;
+    vector<double> ladderMultipliers; // Precomputed per step
+
+    void compileLadder() {
+        ladderMultipliers.assign(1, 1.0);
+        if (ladderStepPercent <= 0) return;
+        for (int step = 1; step <= 100 / ladderStepPercent; ++step) {
+            ladderMultipliers.push_back(1.0 + step * ladderStepMarkup);
+        }
+    }
+
+    void compile() {
+        segmentStart.clear();
+        segmentOffset.clear();
+        segmentRules.clear();
+        for (const auto& r : rules) {
+            segmentStart.push_back(r.fromKey);
+            segmentStart.push_back(r.toKey + 1); // Integer boundary; need not be a real date
+        }
+        sort(segmentStart.begin(), segmentStart.end());
+        segmentStart.erase(unique(segmentStart.begin(), segmentStart.end()), segmentStart.end());
+        for (int32_t start : segmentStart) {
+            segmentOffset.push_back(static_cast<uint32_t>(segmentRules.size()));
+            for (size_t i = 0; i < rules.size(); ++i) {
+                if (rules[i].fromKey <= start && start <= rules[i].toKey) {
+                    segmentRules.push_back(static_cast<uint16_t>(i));
+                }
+            }
+        }
+        segmentOffset.push_back(static_cast<uint32_t>(segmentRules.size()));
+        occupancySensitive = any_of(rules.begin(), rules.end(),
+                                    [](const PricingRule& r) { return r.occLow > 0 || r.occHigh <= 100; });
+    }
+
+public:
+    PricingEngine() { compileLadder(); }
+
+    // One rule at a time (admin edits): the segment index is rebuilt on every call
+    void addRule(const PricingRule& rule) {
+        rules.push_back(rule);
+        compile();
+    }
+
+    // Bulk load: replaces every rule and compiles the segment index once
+    void setRules(vector<PricingRule> newRules) {
+        rules = move(newRules);
+        compile();
+    }
+
+    void setLadder(int stepPercent, double stepMarkup) {
+        ladderStepPercent = max(0, min(stepPercent, 100));
+        ladderStepMarkup = stepMarkup;
+        compileLadder();
+    }
+
+    int getLadderStepPercent() const { return ladderStepPercent; }
+    double getLadderStepMarkup() const { return ladderStepMarkup; }
+    bool isOccupancySensitive() const { return occupancySensitive; }
+
+    // O(1): ladder step for a sold percentage and its precomputed multiplier
+    int ladderStep(int soldPct) const {
+        return ladderStepPercent > 0 ? min(soldPct / ladderStepPercent, static_cast<int>(ladderMultipliers.size()) - 1) : 0;
+    }
+    double ladderMultiplier(int step) const { return ladderMultipliers[static_cast<size_t>(step)]; }
+
+    const vector<PricingRule>& getRules() const { return rules; }
+
+    double multiplier(int32_t dateKey, int occupancyPct, int daysToDeparture) const {
+        auto it = upper_bound(segmentStart.begin(), segmentStart.end(), dateKey);
+        if (it == segmentStart.begin()) return 1.0;
+        size_t segment = static_cast<size_t>(it - segmentStart.begin()) - 1;
+        double m = 1.0;
+        for (uint32_t i = segmentOffset[segment]; i < segmentOffset[segment + 1]; ++i) {
+            const PricingRule& r = rules[segmentRules[i]];
+            if (occupancyPct >= r.occLow && occupancyPct < r.occHigh &&
+                daysToDeparture >= r.daysLow && daysToDeparture <= r.daysHigh) {
+                m *= r.multiplier;
+            }
+        }
+        return m;
+    }
+
+    // Format: Count#Name,From,To,OccLow,OccHigh,DaysLow,DaysHigh,Multiplier@...[^StepPct,StepMarkup]
+    string serialize() const {
+        string data = to_string(rules.size()) + "#";
+        for (const auto& r : rules) {
+            data += r.name + "," + keyToDate(r.fromKey) + "," + keyToDate(r.toKey) + "," +
+                    to_string(r.occLow) + "," + to_string(r.occHigh) + "," + to_string(r.daysLow) + "," +
+                    to_string(r.daysHigh) + "," + to_string(r.multiplier) + "@";
+        }
+        if (ladderStepPercent > 0) {
+            data += "^" + to_string(ladderStepPercent) + "," + to_string(ladderStepMarkup);
+        }
+        return data;
+    }
+
+    // Also accepts the older Name,Date,Multiplier rules (single date, any occupancy)
+    static PricingEngine deserialize(const string& data) {
+        PricingEngine engine;
+        size_t hash = data.find('#');
+        if (hash == string::npos) return engine;
+        size_t caret = data.find('^', hash);
+        if (caret != string::npos) {
+            size_t comma = data.find(',', caret);
+            try {
+                if (comma != string::npos) engine.setLadder(stoi(data.substr(caret + 1)), stod(data.substr(comma + 1)));
+            } catch (const std::exception& e) {
+                cerr << "[Error] Fare ladder deserialization failed: " << e.what() << ". Ignoring ladder." << endl;
+            }
+        }
+        stringstream ss(data.substr(hash + 1, caret == string::npos ? string::npos : caret - hash - 1));
+        string ruleData;
+        vector<PricingRule> parsed;
+        while (getline(ss, ruleData, '@')) {
+            stringstream rs(ruleData);
+            string field;
+            vector<string> f;
+            while (getline(rs, field, ',')) f.push_back(field);
+            try {
+                if (f.size() == 3 && isValidDate(f[1])) {
+                    parsed.push_back({f[0], dateSortKey(f[1]), dateSortKey(f[1]), 0, 101, -(1 << 30), 1 << 30, stod(f[2])});
+                } else if (f.size() == 8 && isValidDate(f[1]) && isValidDate(f[2])) {
+                    parsed.push_back({f[0], dateSortKey(f[1]), dateSortKey(f[2]), stoi(f[3]), stoi(f[4]),
+                                      stoi(f[5]), stoi(f[6]), stod(f[7])});
+                }
+            } catch (const std::exception& e) {
+                cerr << "[Error] Pricing rule deserialization failed: " << e.what() << ". Skipping rule." << endl;
+            }
+        }
+        engine.setRules(move(parsed));
+        return engine;
+    }
+};
+
+// --- NEW CLASS 3e: ConcessionTable (Age/Gender Fare Concessions) ---
+// Fare multipliers precomputed for every (gender, age) pair, so pricing a passenger is
+// one array lookup and a group is a short sum. Every train uses the one standard table.
+class ConcessionTable {
+private:
+    static const int MAX_AGE = 120;
+    float multipliers[3][MAX_AGE + 1]; // [M/F/O][age]
+    uint8_t categories[3][MAX_AGE + 1];  // Index of the distinct multiplier (for quote signatures)
+
+    static int genderIndex(const string& gender) {
+        if (gender == "M" || gender == "m") return 0;
+        if (gender == "F" || gender == "f") return 1;
+        return 2;
+    }
+
+public:
+    // Defaults: children up to 11 pay half; senior men (60+) get 40% off, senior women (58+) 50% off
+    ConcessionTable(double childMultiplier = 0.5, int childMaxAge = 11,
+                    double seniorMaleMultiplier = 0.6, int seniorMaleAge = 60,
+                    double seniorFemaleMultiplier = 0.5, int seniorFemaleAge = 58) {
+        for (int age = 0; age <= MAX_AGE; ++age) {
+            double child = (age <= childMaxAge) ? childMultiplier : 1.0;
+            multipliers[0][age] = static_cast<float>(age >= seniorMaleAge ? seniorMaleMultiplier : child);
+            multipliers[1][age] = static_cast<float>(age >= seniorFemaleAge ? seniorFemaleMultiplier : child);
+            multipliers[2][age] = static_cast<float>(age >= seniorMaleAge ? seniorMaleMultiplier : child);
+        }
+        vector<float> distinct;
+        for (int g = 0; g < 3; ++g) {
+            for (int age = 0; age <= MAX_AGE; ++age) {
+                auto it = find(distinct.begin(), distinct.end(), multipliers[g][age]);
+                if (it == distinct.end()) it = distinct.insert(distinct.end(), multipliers[g][age]);
+                categories[g][age] = static_cast<uint8_t>(min<ptrdiff_t>(it - distinct.begin(), 7));
+            }
+        }
+    }
+
+    static const ConcessionTable& standard() {
+        static const ConcessionTable table;
+        return table;
+    }
+
+    double multiplier(int age, const string& gender) const {
+        return multipliers[genderIndex(gender)][max(0, min(age, MAX_AGE))];
+    }
+
+    // Passenger-mix signature: 8 bits of count per concession category (up to 8 categories).
+    // Groups with the same signature always get the same concession multiplier.
+    template <typename PassengerRange>
+    uint64_t mixSignature(const PassengerRange& passengers) const {
+        uint64_t signature = 0;
+        for (const auto& p : passengers) {
+            int category = categories[genderIndex(p.getGender())][max(0, min(p.getAge(), MAX_AGE))];
+            signature += 1ULL << (category * 8);
+        }
+        return signature;
+    }
+
+    // Sum of multipliers for a group: group fare = per-passenger fare x this
+    template <typename PassengerRange>
+    double groupMultiplier(const PassengerRange& passengers) const {
+        double sum = 0.0;
+        for (const auto& p : passengers) sum += multiplier(p.getAge(), p.getGender());
+        return sum;
+    }
+};
+
+// --- NEW ENUM 4a: TrainType ---
+// Trains live by value in one contiguous vector; the type is a tag, and the few
+// type-specific rules (fare add-ons, display, pantry) switch on it where needed.
+enum class TrainType : uint8_t { Express, Superfast, Passenger, Special };
+
+const Money SUPERFAST_CHARGE = Money::fromPaise(3000); // Flat per-passenger supplement
+
+const char* trainTypeName(TrainType type) {
+    switch (type) {
+        case TrainType::Express: return "EXPRESS";
+        case TrainType::Superfast: return "SUPERFAST";
+        case TrainType::Passenger: return "PASSENGER";
+        case TrainType::Special: return "SPECIAL";
+    }
+    return "EXPRESS";
+}
+
+bool parseTrainType(const string& name, TrainType& type) {
+    for (TrainType t : {TrainType::Express, TrainType::Superfast, TrainType::Passenger, TrainType::Special}) {
+        if (name == trainTypeName(t)) {
+            type = t;
+            return true;
+        }
+    }
+    return false;
+}
+
+// --- NEW CLASS 4b: ServiceCalendar (Running Days) ---
+// A weekly pattern as a 7-bit mask (bit 0 = Monday), a validity window and sorted
+// exception lists, all on Date day numbers. runsOn is one mask test, a range check and
+// two binary searches, so it is cheap enough to gate every seat-map access.
+class ServiceCalendar {
+public:
+    static constexpr uint8_t ALL_DAYS = 0x7F;
+
+private:
+    static constexpr int32_t OPEN_FROM_KEY = 0;        // Persisted bounds of an open window
+    static constexpr int32_t OPEN_TO_KEY = 99991231;
+
+    uint8_t weekdayMask = ALL_DAYS;
+    Date validFrom, validTo;        // Invalid Date = open-ended
+    vector<Date> cancelledDates;    // Sorted; service withdrawn on an otherwise running day
+    vector<Date> extraDates;        // Sorted; service added outside the pattern or window
+
+    static void insertSorted(vector<Date>& days, Date day) {
+        auto it = lower_bound(days.begin(), days.end(), day);
+        if (it == days.end() || *it != day) days.insert(it, day);
+    }
+
+    static void eraseSorted(vector<Date>& days, Date day) {
+        auto it = lower_bound(days.begin(), days.end(), day);
+        if (it != days.end() && *it == day) days.erase(it);
+    }
+
+public:
+    bool runsOn(Date day) const {
+        if (!day.valid()) return false;
+        if (binary_search(extraDates.begin(), extraDates.end(), day)) return true;
+        if ((validFrom.valid() && day < validFrom) || (validTo.valid() && day > validTo)) return false;
+        if (!(weekdayMask & (1u << day.weekday()))) return false;
+        return !binary_search(cancelledDates.begin(), cancelledDates.end(), day);
+    }
+
+    bool isDaily() const {
+        return weekdayMask == ALL_DAYS && !validFrom.valid() && !validTo.valid() &&
+               cancelledDates.empty() && extraDates.empty();
+    }
+
+    uint8_t getWeekdayMask() const { return weekdayMask; }
+    void setWeekdays(uint8_t mask) { weekdayMask = mask & ALL_DAYS; }
+    void setValidity(Date from, Date to) { validFrom = from; validTo = to; }
+
+    void addCancellation(Date day) {
+        eraseSorted(extraDates, day);
+        insertSorted(cancelledDates, day);
+    }
+
+    void addExtraRun(Date day) {
+        eraseSorted(cancelledDates, day);
+        insertSorted(extraDates, day);
+    }
+
+    // "Mon,Wed,Fri" / "Daily" / "None"
+    string weekdaysText() const {
+        static const char* names[] = {"Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun"};
+        if (weekdayMask == ALL_DAYS) return "Daily";
+        string text;
+        for (int d = 0; d < 7; ++d) {
+            if (weekdayMask & (1u << d)) text += string(text.empty() ? "" : ",") + names[d];
+        }
+        return text.empty() ? "None" : text;
+    }
+
+    // Accepts "Daily" or a comma list of day names matched on their first three letters
+    static bool parseWeekdays(const string& text, uint8_t& mask) {
+        static const char* names[] = {"mon", "tue", "wed", "thu", "fri", "sat", "sun"};
+        string lower = text;
+        transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+        if (lower == "daily") {
+            mask = ALL_DAYS;
+            return true;
+        }
+        uint8_t parsed = 0;
+        stringstream ss(lower);
+        string day;
+        while (getline(ss, day, ',')) {
+            int d = 0;
+            while (d < 7 && day.compare(0, 3, names[d]) != 0) ++d;
+            if (d == 7 || day.size() < 3) return false;
+            parsed |= static_cast<uint8_t>(1u << d);
+        }
+        if (parsed == 0) return false;
+        mask = parsed;
+        return true;
+    }
+
+    void display(ReportBuffer& out) const {
+        out << "    Runs: " << weekdaysText();
+        if (validFrom.valid() || validTo.valid()) {
+            out << " (" << (validFrom.valid() ? validFrom.toString() : string("...")) << " to "
+                << (validTo.valid() ? validTo.toString() : string("...")) << ')';
+        }
+        out << '\n';
+        if (!cancelledDates.empty()) {
+            out << "    Cancelled:";
+            for (Date day : cancelledDates) out << ' ' << day.toString();
+            out << '\n';
+        }
+        if (!extraDates.empty()) {
+            out << "    Extra Runs:";
+            for (Date day : extraDates) out << ' ' << day.toString();
+            out << '\n';
+        }
+    }
+
+    // Format: CAL:Mask(hex),From,To[,-Cancelled...][,+Extra...] with YYYYMMDD dates
+    // (0 and 99991231 for an open window)
+    string serialize() const {
+        char mask[8];
+        snprintf(mask, sizeof(mask), "%02X", weekdayMask);
+        string data = string("CAL:") + mask + "," + to_string(validFrom.valid() ? validFrom.key() : OPEN_FROM_KEY) +
+                      "," + to_string(validTo.valid() ? validTo.key() : OPEN_TO_KEY);
+        for (Date day : cancelledDates) data += ",-" + to_string(day.key());
+        for (Date day : extraDates) data += ",+" + to_string(day.key());
+        return data;
+    }
+
+    // Throws on a malformed field
+    static ServiceCalendar deserialize(const string& data) {
+        if (data.compare(0, 4, "CAL:") != 0) throw invalid_argument("bad calendar '" + data + "'");
+        ServiceCalendar calendar;
+        stringstream ss(data.substr(4));
+        string item;
+        vector<string> f;
+        while (getline(ss, item, ',')) f.push_back(item);
+        if (f.size() < 3) throw invalid_argument("bad calendar '" + data + "'");
+        auto bound = [](const string& text, int32_t openKey) {
+            int32_t key = stoi(text);
+            return key == openKey ? Date() : Date::fromKey(key);
+        };
+        calendar.setWeekdays(static_cast<uint8_t>(stoi(f[0], nullptr, 16)));
+        calendar.setValidity(bound(f[1], OPEN_FROM_KEY), bound(f[2], OPEN_TO_KEY));
+        for (size_t i = 3; i < f.size(); ++i) {
+            if (f[i].size() < 2) continue;
+            Date day = Date::fromKey(stoi(f[i].substr(1)));
+            if (f[i][0] == '-') calendar.addCancellation(day);
+            else if (f[i][0] == '+') calendar.addExtraRun(day);
+        }
+        return calendar;
+    }
+};
+
+// --- 4. Train Class (Tagged by TrainType) ---
+class Train {
+protected:
+    TrainType type;
+    bool hasPantryCar;        // Express/Superfast/Special; always false for Passenger
+    int specialPremiumPct;    // Special trains only: premium over the base fare
+    string trainNumber;
+    string trainName;
+    Route route; // Using the new Route class
+    int classSeats[CLASS_COUNT] = {}; // Capacity per CoachClass (0 = class not offered)
+    Money classFare[CLASS_COUNT] = {};
+    int totalSeats = 0;               // Sum over classes
+    PricingEngine pricing; // Dynamic fare rules for this train
+    ServiceCalendar calendar; // Running days; seat map blocks exist only for these
+    
+    InventorySlot seatSlot; // This train's seat map: its run of blocks in the SeatInventory
+
+    static SeatInventory& inventory() { return SeatInventory::getInstance(); }
+    FareCache& fareCacheOf(const SeatAllocation& alloc) { return inventory().faresOf(alloc); }
+
+    SeatAllocation freshAllocation(Date day) const {
+        SeatAllocation alloc;
+        alloc.date = day;
+        copy(begin(classSeats), end(classSeats), begin(alloc.available));
+        return alloc;
+    }
+
+public:
+    // Constructor (Updated to use Route object). 'seats'/'fare' configure Sleeper (SL);
+    // other classes are added with configureClass.
+    Train(TrainType trainType, const string& num, const string& name, const Route& r, int seats, Money fare,
+          bool pantry, int premiumPct = 0)
+        : type(trainType), hasPantryCar(pantry && trainType != TrainType::Passenger),
+          specialPremiumPct(trainType == TrainType::Special ? premiumPct : 0),
+          trainNumber(num), trainName(name), route(r) {
+        configureClass(CLASS_SL, seats, fare);
+    }
+
+    // Sets a class's capacity and fare while the train is being built (no bookings yet):
+    // every known date is reset to the new capacity for that class.
+    void configureClass(int cls, int seats, Money fare) {
+        totalSeats += seats - classSeats[cls];
+        classSeats[cls] = seats;
+        classFare[cls] = fare;
+        for (auto& alloc : inventory().blocksOf(seatSlot.get())) alloc.available[cls] = seats;
+        invalidateFares();
+    }
+
+    // Seats/fare record fields: the old single "10" / "55.00" when only SL is offered,
+    // else "SL=300,3A=64" / "SL=450.00,3A=1200.00"
+    string classSeatsField() const {
+        if (offersOnlySleeper()) return to_string(classSeats[CLASS_SL]);
+        string field;
+        for (int c = 0; c < CLASS_COUNT; ++c) {
+            if (classSeats[c] > 0) field += string(field.empty() ? "" : ",") + coachClassName(c) + "=" + to_string(classSeats[c]);
+        }
+        return field;
+    }
+
+    string classFareField() const {
+        if (offersOnlySleeper()) return classFare[CLASS_SL].toString();
+        string field;
+        for (int c = 0; c < CLASS_COUNT; ++c) {
+            if (classSeats[c] > 0) field += string(field.empty() ? "" : ",") + coachClassName(c) + "=" + classFare[c].toString();
+        }
+        return field;
+    }
+
+    // Inverse of classSeatsField/classFareField; throws on a malformed field
+    void configureClasses(const string& seatsField, const string& faresField) {
+        if (seatsField.find('=') == string::npos) {
+            configureClass(CLASS_SL, stoi(seatsField), Money::parseOrThrow(faresField));
+            return;
+        }
+        configureClass(CLASS_SL, 0, Money());
+        auto forEachClass = [](const string& field, auto apply) {
+            stringstream ss(field);
+            string item;
+            while (getline(ss, item, ',')) {
+                size_t eq = item.find('=');
+                int cls;
+                if (eq == string::npos || !parseCoachClass(item.substr(0, eq), cls)) {
+                    throw invalid_argument("bad class entry '" + item + "'");
+                }
+                apply(cls, item.substr(eq + 1));
+            }
+        };
+        int seats[CLASS_COUNT] = {};
+        forEachClass(seatsField, [&seats](int cls, const string& v) { seats[cls] = stoi(v); });
+        forEachClass(faresField, [this, &seats](int cls, const string& v) {
+            configureClass(cls, seats[cls], Money::parseOrThrow(v));
+        });
+    }
+
+    // Renders into 'out'; the no-argument form writes straight to the console
+    void displayDetails(ReportBuffer& out) const {
+        out << "    Train Number: " << trainNumber << '\n';
+        out << "    Train Name: " << trainName << " (" << trainTypeName(type) << ")\n";
+        out << "    Route: " << route.getSource() << " -> " << route.getDestination() << '\n';
+        out << "    Total Seats: " << totalSeats << '\n';
+        for (int c = 0; c < CLASS_COUNT; ++c) {
+            if (classSeats[c] == 0) continue;
+            out << "    Class " << coachClassName(c) << ": " << classSeats[c] << " seats, Base Fare: ₹";
+            out.fixed2(classFare[c]) << '\n';
+        }
+        switch (type) {
+            case TrainType::Superfast:
+                out << "    Superfast Charge: ₹" << SUPERFAST_CHARGE << " per passenger\n";
+                break;
+            case TrainType::Passenger:
+                out << "    Passenger/Local: flat fare, no surge\n";
+                break;
+            case TrainType::Special:
+                out << "    Special Fare Premium: " << specialPremiumPct << "%\n";
+                break;
+            case TrainType::Express:
+                break;
+        }
+        if (type != TrainType::Passenger) out << "    Pantry Car: " << (hasPantryCar ? "Yes" : "No") << '\n';
+        calendar.display(out);
+        route.displaySchedule(out); // Displaying schedule
+    }
+    void displayDetails() const {
+        ReportBuffer& out = ReportBuffer::console();
+        displayDetails(out);
+        out.flush();
+    }
+    
+    // TRAIN record fields (data file version 2); 'calendar' is empty for a daily train
+    static const vector<string>& recordSchema() {
+        static const vector<string> names = {"type", "number", "name", "source", "destination", "timetable",
+                                             "seats", "fares", "pantry", "premium", "pricing", "calendar", "seatmap"};
+        return names;
+    }
+
+    vector<string> recordFields() const {
+        return {trainTypeName(type), trainNumber, trainName, route.getSource(), route.getDestination(),
+                to_string(route.timetableId()), classSeatsField(), classFareField(), hasPantryCar ? "1" : "0",
+                to_string(specialPremiumPct), pricing.serialize(), calendar.isDaily() ? "" : calendar.serialize(),
+                serializeSeatMap()};
+    }
+
+    string serialize() const { return formatRecord("TRAIN", recordFields()); }
+
+    // Everything but the seat map, which the loader parses (and times) separately.
+    // Throws on a malformed record.
+    static Train fromRecord(const DataRecord& rec, const vector<shared_ptr<const Timetable>>& fileTimetables) {
+        TrainType type;
+        if (!parseTrainType(rec.get("type"), type)) throw invalid_argument("unknown train type '" + rec.get("type") + "'");
+        const string& premium = rec.get("premium");
+        Train t(type, rec.get("number"), rec.get("name"),
+                Route::fromRecord(rec.get("source"), rec.get("destination"), rec.get("timetable"), fileTimetables),
+                0, Money(), rec.get("pantry") == "1", premium.empty() ? 0 : stoi(premium));
+        t.configureClasses(rec.get("seats"), rec.get("fares"));
+        if (!rec.get("pricing").empty()) t.setPricing(PricingEngine::deserialize(rec.get("pricing")));
+        if (!rec.get("calendar").empty()) t.setCalendar(ServiceCalendar::deserialize(rec.get("calendar")));
+        return t;
+    }
+
+    // Getters
+    TrainType getType() const { return type; }
+    bool getPantryStatus() const { return hasPantryCar; }
+    int getSpecialPremiumPct() const { return specialPremiumPct; }
+    string getTrainNumber() const { return trainNumber; }
+    string getTrainName() const { return trainName; }
+    string getSource() const { return route.getSource(); }
+    string getDestination() const { return route.getDestination(); }
+    const Route& getRoute() const { return route; }
+    int getTotalSeats() const { return totalSeats; }
+    int getClassSeats(int cls) const { return classSeats[cls]; }
+    Money getClassFare(int cls) const { return classFare[cls]; }
+    bool offersClass(int cls) const { return cls >= 0 && cls < CLASS_COUNT && classSeats[cls] > 0; }
+    bool offersOnlySleeper() const { return totalSeats == classSeats[CLASS_SL]; }
+    const PricingEngine& getPricing() const { return pricing; }
+    void setPricing(const PricingEngine& p) { pricing = p; invalidateFares(); }
+    void addPricingRule(const PricingRule& rule) { pricing.addRule(rule); invalidateFares(); }
+    void setFareLadder(int stepPercent, double stepMarkup) { pricing.setLadder(stepPercent, stepMarkup); invalidateFares(); }
+
+    int soldPercent(const SeatAllocation& alloc) const {
+        return totalSeats > 0 ? (totalSeats - alloc.totalAvailable()) * 100 / totalSeats : 0;
+    }
+
+    // Passenger/Local trains never surge, so they stay on step 0
+    int ladderStepFor(const SeatAllocation& alloc) const {
+        return type == TrainType::Passenger ? 0 : pricing.ladderStep(soldPercent(alloc));
+    }
+
+    // Called as inventory moves: O(1) ladder step update. The cached fare only goes stale
+    // when the step changes (or on every move if a rule depends on occupancy).
+    void repriceOnInventoryChange(SeatAllocation& alloc) {
+        FareCache& fares = fareCacheOf(alloc);
+        int step = ladderStepFor(alloc);
+        if (step != fares.fareStep || pricing.isOccupancySensitive()) {
+            fares.fareStep = step;
+            fares.pricedDay = -1;
+            fares.pricingVersion = nextPricingVersion();
+        }
+    }
+
+    void invalidateFares() {
+        for (auto& fares : inventory().faresOf(seatSlot.get())) {
+            fares.pricedDay = -1;
+            fares.pricingVersion = nextPricingVersion();
+        }
+    }
+
+    // Prices every class of 'alloc' for 'today' in one pass
+    void priceAllocation(const SeatAllocation& alloc, FareCache& fares, Date today) const {
+        fares.fareStep = ladderStepFor(alloc);
+        double m = pricing.multiplier(alloc.date.key(), soldPercent(alloc), alloc.date - today) *
+                   pricing.ladderMultiplier(fares.fareStep);
+        if (type == TrainType::Special) m *= 1.0 + specialPremiumPct / 100.0;
+        for (int c = 0; c < CLASS_COUNT; ++c) {
+            fares.liveFare[c] = classFare[c].scaled(m);
+            if (type == TrainType::Superfast) fares.liveFare[c] += SUPERFAST_CHARGE;
+        }
+        fares.pricedDay = today.dayNumber();
+    }
+
+    // Live per-passenger fare for 'date' in class 'cls': served from the seat map cache;
+    // rules are only evaluated when the cache is stale (step change, rule change, or a
+    // new day), and then every class is priced in the same pass. A running day with no
+    // block yet is priced on a scratch block, so quoting never adds one to the seat map.
+    Money liveFare(Date day, int cls = CLASS_SL) {
+        if (!calendar.runsOn(day)) return classFare[cls]; // Invalid date or not a running day
+        Date today = Date::today();
+        SeatAllocation* alloc = existingAllocation(day);
+        if (!alloc) {
+            FareCache scratch;
+            priceAllocation(freshAllocation(day), scratch, today);
+            return scratch.liveFare[cls];
+        }
+        FareCache& fares = fareCacheOf(*alloc);
+        if (fares.pricedDay != today.dayNumber()) priceAllocation(*alloc, fares, today);
+        return fares.liveFare[cls];
+    }
+
+    // 0 if the day has no seat block yet
+    uint32_t pricingVersion(Date day) const {
+        const SeatAllocation* alloc = existingAllocation(day);
+        return alloc ? inventory().faresOf(*alloc).pricingVersion : 0;
+    }
+
+    int fareStep(Date day) const {
+        const SeatAllocation* alloc = existingAllocation(day);
+        return alloc ? inventory().faresOf(*alloc).fareStep : 0;
+    }
+
+    // Fare for a group on 'date' at the current (pre-booking) price
+    Money quoteFare(Date day, int numPassengers, int cls = CLASS_SL) {
+        return liveFare(day, cls) * numPassengers;
+    }
+
+    // Group fare with age/gender concessions: one live-fare read, then table lookups
+    template <typename PassengerRange>
+    Money quoteGroupFare(Date day, const PassengerRange& passengers, int cls = CLASS_SL) {
+        return liveFare(day, cls).scaled(getConcessions().groupMultiplier(passengers));
+    }
+
+    // Concessions are system-wide: not persisted, captured or configurable per train
+    const ConcessionTable& getConcessions() const { return ConcessionTable::standard(); }
+
+    const ServiceCalendar& getCalendar() const { return calendar; }
+    bool runsOn(Date day) const { return calendar.runsOn(day); }
+
+    // Replaces the calendar and drops untouched seat map blocks for days the train no longer
+    // runs; blocks with sales or a prepared chart are kept so existing tickets stay valid
+    void setCalendar(const ServiceCalendar& cal) {
+        calendar = cal;
+        pruneIdleDays();
+    }
+
+    // Drops seat map blocks of non-running days that have no sales and no chart
+    void pruneIdleDays() {
+        inventory().eraseIf(seatSlot.get(), [this](const SeatAllocation& alloc) {
+            return !calendar.runsOn(alloc.date) && !alloc.chartPrepared &&
+                   equal(begin(alloc.available), end(alloc.available), begin(classSeats));
+        });
+    }
+
+    // Seat map block for 'date' on the selling paths (search, quote, book); an unseen running
+    // day starts at full availability. Returns nullptr for an invalid date or a day the train
+    // does not run, even if a block with earlier sales survives for it.
+    SeatAllocation* allocationFor(Date day) {
+        if (!calendar.runsOn(day)) return nullptr; // Also rejects invalid dates
+        return &inventory().findOrInsert(seatSlot.get(), day, freshAllocation(day));
+    }
+
+    // Block already on the seat map for 'date', running day or not (cancel, chart, refund)
+    SeatAllocation* existingAllocation(Date day) { return inventory().find(seatSlot.get(), day); }
+    const SeatAllocation* existingAllocation(Date day) const { return inventory().find(seatSlot.get(), day); }
+
+    // Seat management using date: all classes together, or one class. Read-only: an unseen
+    // running day reports full capacity without adding a block.
+    int getAvailableSeats(Date day) const {
+        if (!calendar.runsOn(day)) return -1; // -1 = invalid date or not a running day
+        const SeatAllocation* alloc = existingAllocation(day);
+        return alloc ? alloc->totalAvailable() : totalSeats;
+    }
+
+    int getAvailableSeats(Date day, int cls) const {
+        if (!calendar.runsOn(day)) return -1;
+        const SeatAllocation* alloc = existingAllocation(day);
+        return alloc ? alloc->available[cls] : classSeats[cls];
+    }
+
+    bool bookSeat(Date day, int count = 1, int cls = CLASS_SL) {
+        SeatAllocation* alloc = allocationFor(day);
+        if (!alloc || alloc->chartPrepared) return false; // Invalid date or inventory frozen
+        if (alloc->available[cls] < count) return false; // Not enough seats
+        alloc->available[cls] -= count;
+        repriceOnInventoryChange(*alloc);
+        return true;
+    }
+    
+    void cancelSeat(Date day, int count = 1, int cls = CLASS_SL) {
+        SeatAllocation* alloc = existingAllocation(day);
+        if (!alloc || alloc->chartPrepared) return; // Nothing sold, or inventory frozen
+        alloc->available[cls] = min(alloc->available[cls] + count, classSeats[cls]);
+        repriceOnInventoryChange(*alloc);
+    }
+
+    // Serialize seat map (complex persistence part)
+    string serializeSeatMap() const {
+        auto blocks = getSeatMap();
+        string data = to_string(blocks.size()) + ":";
+        for (const auto& alloc : blocks) {
+            data += alloc.serialize() + ";";
+        }
+        return data; // Format: Count:Date1|Seats1;Date2|Seats2;
+    }
+
+    // Deserialize seat map; blocks are sorted by date and a repeated date keeps the first
+    void deserializeSeatMap(const string& data) {
+        inventory().release(seatSlot.get());
+        size_t count_end = data.find(':');
+        if (count_end == string::npos) return;
+
+        string count_str = data.substr(0, count_end);
+        int count = 0;
+        try {
+            count = stoi(count_str);
+        } catch (...) {
+            return; // Crash defense
+        }
+        
+        string segment = data.substr(count_end + 1);
+        stringstream ss(segment);
+        string alloc_data;
+        vector<SeatAllocation> parsed;
+        
+        for (int i = 0; i < count && getline(ss, alloc_data, ';'); ++i) {
+            SeatAllocation alloc = SeatAllocation::deserialize(alloc_data);
+            if (alloc.date.valid()) parsed.push_back(alloc); // Malformed blocks are dropped
+        }
+        stable_sort(parsed.begin(), parsed.end(),
+                    [](const SeatAllocation& a, const SeatAllocation& b) { return a.date < b.date; });
+        parsed.erase(unique(parsed.begin(), parsed.end(),
+                            [](const SeatAllocation& a, const SeatAllocation& b) { return a.date == b.date; }),
+                     parsed.end());
+        inventory().assign(seatSlot.get(), parsed);
+    }
+    
+    // Reservation chart state per date
+    bool isChartPrepared(Date day) const {
+        const SeatAllocation* alloc = existingAllocation(day);
+        return alloc && alloc->chartPrepared;
+    }
+
+    void freezeInventory(Date day) {
+        SeatAllocation* alloc = existingAllocation(day);
+        if (!alloc) alloc = allocationFor(day);
+        if (alloc) alloc->chartPrepared = true;
+    }
+
+    size_t getSeatMapSize() const { return getSeatMap().size(); }
+    BlockRange<const SeatAllocation> getSeatMap() const {
+        const SeatInventory& blocks = inventory();
+        return blocks.blocksOf(seatSlot.get());
+    }
+
+};
+
+// --- NEW STRUCT 6a: WaitlistEntry ---
+struct WaitlistEntry {
+    string pnr;
+    string date;
+    int numSeats;
+    int rank; // Waitlist position
+    int coachClass = CLASS_SL; // Only seats of this class can promote the entry
+
+    string serialize() const {
+        return pnr + "|" + date + "|" + to_string(numSeats) + "|" + to_string(rank);
+    }
+};
+
+using WaitlistQueue = vector<WaitlistEntry, TaggedAllocator<WaitlistEntry, MemTag::Waitlists>>;
+using WaitlistMap = map<string, WaitlistQueue, less<string>,
+                        TaggedAllocator<pair<const string, WaitlistQueue>, MemTag::Waitlists>>;
+
+using PassengerList = vector<Passenger, TaggedAllocator<Passenger, MemTag::Passengers>>;
+
+// --- NEW STRUCT 6b: GroupRequest (one group in a multi-group booking) ---
+struct GroupRequest {
+    string trainNumber;
+    string date;
+    vector<Passenger> passengers;
+    int coachClass = CLASS_SL;
+    string boardingStation; // Empty = the train's origin
+};
+
+// --- NEW CLASS 6c: FareQuoteCache ---
+// Group quotes keyed by (train, journey date, class, quota, passenger-mix signature).
+// Each entry remembers the (train, date) pricing version and the day it was priced;
+// a version bump (ladder step crossed, rules changed) or a new day makes it a miss.
+struct FareQuoteKey {
+    string trainNumber;
+    int32_t dateKey;
+    uint8_t classCode;   // CoachClass
+    uint8_t quota;       // 0 = General
+    uint64_t mixSignature;
+
+    bool operator==(const FareQuoteKey& o) const {
+        return dateKey == o.dateKey && classCode == o.classCode && quota == o.quota &&
+               mixSignature == o.mixSignature && trainNumber == o.trainNumber;
+    }
+};
+
+struct FareQuoteKeyHash {
+    size_t operator()(const FareQuoteKey& k) const {
+        size_t h = hash<string>()(k.trainNumber);
+        h ^= hash<uint64_t>()((static_cast<uint64_t>(static_cast<uint32_t>(k.dateKey)) << 16) ^
+                              (static_cast<uint64_t>(k.classCode) << 8) ^ k.quota) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+        h ^= hash<uint64_t>()(k.mixSignature) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+        return h;
+    }
+};
+
+class FareQuoteCache {
+private:
+    struct Entry {
+        Money fare;
+        uint32_t pricingVersion;
+        long long pricedDay;
+    };
+    unordered_map<FareQuoteKey, Entry, FareQuoteKeyHash> entries;
+    size_t maxEntries;
+    unsigned long long hits = 0, misses = 0;
+
+public:
+    explicit FareQuoteCache(size_t capacity = 100000) : maxEntries(capacity) {}
+
+    bool lookup(const FareQuoteKey& key, uint32_t pricingVersion, long long today, Money& fare) {
+        auto it = entries.find(key);
+        if (it != entries.end() && it->second.pricingVersion == pricingVersion && it->second.pricedDay == today) {
+            fare = it->second.fare;
+            hits++;
+            return true;
+        }
+        misses++;
+        return false;
+    }
+
+    void store(const FareQuoteKey& key, uint32_t pricingVersion, long long today, Money fare) {
+        if (entries.size() >= maxEntries) entries.clear(); // Crude bound; stale entries die here too
+        entries[key] = {fare, pricingVersion, today};
+    }
+
+    void clear() { entries.clear(); }
+
+    size_t size() const { return entries.size(); }
+    unsigned long long getHits() const { return hits; }
+    unsigned long long getMisses() const { return misses; }
+};
+
+// --- 6. Booking/Ticket Class ---
+class Booking {
+private:
+    string pnrNumber; 
+    string trainNumber;
+    string dateOfJourney;
+    PassengerList passengers;
+    Money totalFare;
+    string status; // Confirmed/Cancelled/Waitlist/Failed
+    int coachClass = CLASS_SL;
+    string boardingStation; // Empty = the train's origin
+
+public:
+    // Constructor
+    Booking(const string& pnr, const string& tNum, const string& date, const vector<Passenger>& p_list, Money fare, const string& initialStatus = "Confirmed",
+            int cls = CLASS_SL, const string& boarding = "")
+        : pnrNumber(pnr), trainNumber(tNum), dateOfJourney(date), passengers(p_list.begin(), p_list.end()), totalFare(fare), status(initialStatus),
+          coachClass(cls), boardingStation(boarding) {}
+
+    // Default Constructor for File Loading
+    Booking() : pnrNumber(""), trainNumber(""), dateOfJourney(""), totalFare(), status("") {}
+
+    // Getters
+    string getPNR() const { return pnrNumber; }
+    string getTrainNumber() const { return trainNumber; }
+    string getDate() const { return dateOfJourney; }
+    Money getTotalFare() const { return totalFare; }
+    string getStatus() const { return status; }
+    int getCoachClass() const { return coachClass; }
+    const string& getBoardingStation() const { return boardingStation; }
+    const PassengerList& getPassengers() const { return passengers; }
+    
+    // Mutator
+    void setStatus(const string& newStatus) { status = newStatus; }
+
+    // Display (Also handles viewing confirmed/waitlist status)
+    void displayBooking(ReportBuffer& out) const {
+        out << "\n    --- Booking Details (PNR: " << pnrNumber << ") ---\n";
+        out << "    Train Number: " << trainNumber << ", Date: " << dateOfJourney
+            << ", Class: " << coachClassName(coachClass) << '\n';
+        if (!boardingStation.empty()) out << "    Boarding At: " << boardingStation << '\n';
+        out << "    Booking Status: " << status << '\n';
+        out << (status == "Failed" ? "    Fare Quoted (payment declined): ₹" : "    Total Fare Paid: ₹");
+        out.fixed2(totalFare) << '\n';
+        out << "    Passengers (" << passengers.size() << "):\n";
+        for (const auto& p : passengers) {
+            p.displayPassenger(out);
+        }
+        out << "    -------------------------------------------------\n";
+    }
+    void displayBooking() const {
+        ReportBuffer& out = ReportBuffer::console();
+        displayBooking(out);
+        out.flush();
+    }
+    
+    int getNumPassengers() const {
+        return passengers.size();
+    }
+    
+    // BOOKING record fields (data file version 2); passengers are Name|Age|Gender joined by '&',
+    // and 'boarding' is empty when the passengers board at the train's origin
+    static const vector<string>& recordSchema() {
+        static const vector<string> names = {"pnr", "train", "date", "class", "fare", "status", "passengers", "boarding"};
+        return names;
+    }
+
+    vector<string> recordFields() const {
+        string p_data;
+        for (const auto& p : passengers) {
+            p_data += (p_data.empty() ? "" : "&") + p.serialize();
+        }
+        return {pnrNumber, trainNumber, dateOfJourney, coachClassName(coachClass), totalFare.toString(), status, p_data,
+                boardingStation};
+    }
+
+    string serialize() const { return formatRecord("BOOKING", recordFields()); }
+
+    static Booking fromRecord(const DataRecord& rec) {
+        Booking b;
+        try {
+            b.pnrNumber = rec.get("pnr");
+            b.trainNumber = rec.get("train");
+            b.dateOfJourney = rec.get("date");
+            if (!parseCoachClass(rec.get("class"), b.coachClass)) b.coachClass = CLASS_SL;
+            b.totalFare = Money::parseOrThrow(rec.get("fare"));
+            b.status = rec.get("status");
+            b.boardingStation = rec.get("boarding"); // Absent before boarding points were stored
+
+            stringstream pss(rec.get("passengers"));
+            string p_segment;
+            while (getline(pss, p_segment, '&')) {
+                stringstream psss(p_segment);
+                string p_part;
+                vector<string> p_parts;
+                while (getline(psss, p_part, '|')) {
+                    p_parts.push_back(p_part);
+                }
+                if (p_parts.size() == 3) {
+                    b.passengers.emplace_back(p_parts[0], stoi(p_parts[1]), p_parts[2]);
+                }
+            }
+        } catch (const std::exception& e) {
+            cerr << "[Error] Booking deserialization failed: " << e.what() << ". Skipping record." << endl;
+            return Booking(); // Return empty booking on exception
+        }
+        return b;
+    }
+};
+
+// --- NEW CLASS 7a: PnrBloomFilter (Fast Negative PNR Lookups) ---
+// Answers "was this PNR ever issued?" with no false negatives and about 1% false
+// positives, in a few bit tests. It grows as a scalable Bloom filter: when a layer
+// reaches its capacity a new one twice the size is added, and a lookup checks each
+// layer, so nothing ever has to be rehashed from the booking list.
+class PnrBloomFilter {
+private:
+    static constexpr int HASHES = 7;           // ~optimal for 10 bits per key
+    static constexpr size_t BITS_PER_KEY = 10; // ~0.8% false positives per layer
+
+    struct Layer {
+        vector<uint64_t, TaggedAllocator<uint64_t, MemTag::Indexes>> words;
+        uint64_t bitCount;
+        size_t capacity;
+        size_t keys = 0;
+    };
+    vector<Layer> layers;
+    size_t nextCapacity;
+    mutable unsigned long long lookups = 0, rejected = 0;
+
+    static uint64_t mix(uint64_t x) { // splitmix64 finalizer
+        x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    // Two independent 64-bit hashes; probe i is h1 + i*h2 (Kirsch-Mitzenmacher)
+    static void hashes(string_view pnr, uint64_t& h1, uint64_t& h2) {
+        uint64_t h = 14695981039346656037ULL;
+        for (unsigned char c : pnr) {
+            h ^= c;
+            h *= 1099511628211ULL;
+        }
+        h1 = mix(h);
+        h2 = mix(h ^ 0x9e3779b97f4a7c15ULL) | 1;
+    }
+
+    void addLayer() {
+        Layer layer;
+        layer.capacity = nextCapacity;
+        layer.bitCount = static_cast<uint64_t>(nextCapacity) * BITS_PER_KEY;
+        layer.words.assign((layer.bitCount + 63) / 64, 0);
+        layers.push_back(move(layer));
+        nextCapacity *= 2;
+    }
+
+public:
+    explicit PnrBloomFilter(size_t initialCapacity = 4096) : nextCapacity(max<size_t>(initialCapacity, 64)) {}
+
+    void add(string_view pnr) {
+        if (layers.empty() || layers.back().keys >= layers.back().capacity) addLayer();
+        Layer& layer = layers.back();
+        uint64_t h1, h2;
+        hashes(pnr, h1, h2);
+        for (int i = 0; i < HASHES; ++i) {
+            uint64_t bit = (h1 + static_cast<uint64_t>(i) * h2) % layer.bitCount;
+            layer.words[bit >> 6] |= 1ULL << (bit & 63);
+        }
+        layer.keys++;
+    }
+
+    // False means the PNR was definitely never issued
+    bool mightContain(string_view pnr) const {
+        lookups++;
+        uint64_t h1, h2;
+        hashes(pnr, h1, h2);
+        for (const Layer& layer : layers) {
+            bool all = true;
+            for (int i = 0; i < HASHES && all; ++i) {
+                uint64_t bit = (h1 + static_cast<uint64_t>(i) * h2) % layer.bitCount;
+                all = (layer.words[bit >> 6] >> (bit & 63)) & 1;
+            }
+            if (all) return true;
+        }
+        rejected++;
+        return false;
+    }
+
+    // Sizes the first layer for 'expectedKeys' and drops everything
+    void reset(size_t expectedKeys) {
+        layers.clear();
+        nextCapacity = max<size_t>(expectedKeys + expectedKeys / 4, 64);
+    }
+
+    size_t keyCount() const {
+        size_t total = 0;
+        for (const Layer& layer : layers) total += layer.keys;
+        return total;
+    }
+    size_t layerCount() const { return layers.size(); }
+    size_t byteSize() const {
+        size_t total = 0;
+        for (const Layer& layer : layers) total += layer.words.size() * sizeof(uint64_t);
+        return total;
+    }
+    unsigned long long getLookups() const { return lookups; }
+    unsigned long long getRejected() const { return rejected; }
+};
+
+// --- NEW CLASS 7: PNRGenerator ---
+class PNRGenerator {
+private:
+    long long currentPNR = 100000000000;
+    
+    void savePNR() const {
+        ofstream pnrFile(PNR_FILE);
+        if (pnrFile.is_open()) {
+            pnrFile << currentPNR;
+            pnrFile.close();
+        }
+    }
+
+    void loadPNR() {
+        ifstream pnrFile(PNR_FILE);
+        if (pnrFile.is_open()) {
+            // FIX: Robust check to handle empty or malformed file content
+            string pnr_str;
+            if (pnrFile >> pnr_str && !pnr_str.empty()) {
+                try {
+                    currentPNR = stoll(pnr_str);
+                } catch (const std::exception& e) {
+                    // Fallback if file content is non-numeric or malformed
+                    currentPNR = 100000000000;
+                    cerr << "[Warning] PNR file corrupted (" << e.what() << "). Resetting counter." << endl;
+                }
+            }
+        }
+        if (currentPNR < 100000000000) {
+            currentPNR = 100000000000;
+        }
+    }
+    
+    PnrBloomFilter issued; // Every PNR handed out (and every PNR loaded from disk)
+
+public:
+    PNRGenerator() {
+        loadPNR();
+    }
+
+    string generate() {
+        currentPNR++;
+        savePNR();
+        string pnr = to_string(currentPNR);
+        issued.add(pnr);
+        return pnr;
+    }
+
+    // Rebuilt by the loader from the persisted bookings (payment-failed attempts included,
+    // as Failed bookings), sized for 'expectedKeys' PNRs
+    void resetIssued(size_t expectedKeys) { issued.reset(expectedKeys); }
+    void noteIssued(const string& pnr) { issued.add(pnr); }
+
+    // False only for PNRs that were never issued, so callers can skip the lookup
+    bool mayExist(const string& pnr) const { return issued.mightContain(pnr); }
+    const PnrBloomFilter& getIssuedFilter() const { return issued; }
+    long long lastIssued() const { return currentPNR; }
+};
+
+// --- NEW CLASS 8: User Base Class (Polymorphism) ---
+class User {
+protected:
+    string username;
+    string password;
+    string role;
+public:
+    User(const string& u, const string& p, const string& r) : username(u), password(p), role(r) {}
+    
+    virtual void displayMenu() const = 0;
+    string getUsername() const { return username; }
+    string getRole() const { return role; }
+    
+    // Only checks the password argument
+    bool authenticate(const string& inputPassword) const { return password == inputPassword; }
+    
+    // USER record fields (data file version 2); the role picks the derived class on load
+    static const vector<string>& recordSchema() {
+        static const vector<string> names = {"role", "username", "password"};
+        return names;
+    }
+    vector<string> recordFields() const { return {role, username, password}; }
+
+    // Heap accounting for user objects
+    static void* operator new(size_t bytes) {
+        memTrackAlloc(MemTag::Users, bytes);
+        return ::operator new(bytes);
+    }
+    static void operator delete(void* p, size_t bytes) {
+        memTrackFree(MemTag::Users, bytes);
+        ::operator delete(p);
+    }
+
+    virtual ~User() {}
+};
+
+// --- NEW CLASS 9: Admin (Derived from User) ---
+class Admin : public User {
+public:
+    Admin(const string& u, const string& p) : User(u, p, "Admin") {}
+    
+    void displayMenu() const override {
+        cout << "\n==============================================" << endl;
+        cout << "🔒 **Admin Menu** 🔒" << endl;
+        cout << "==============================================" << endl;
+        cout << "1. View All Trains (Basic Details)" << endl;
+        cout << "2. View Train Availability by Date" << endl;
+        cout << "3. **Add New Train (Express/Superfast/Passenger/Special)**" << endl;
+        cout << "4. Remove Train" << endl;
+        cout << "5. **View All Bookings**" << endl; 
+        cout << "6. Process Waitlist (Manual)" << endl;
+        cout << "7. View System Stats (Memory)" << endl;
+        cout << "8. Export Data (CSV/NDJSON)" << endl;
+        cout << "9. Revenue & Occupancy Report" << endl;
+        cout << "10. Live Occupancy Dashboard" << endl;
+        cout << "11. Prepare Reservation Charts" << endl;
+        cout << "12. Transaction Time-Series" << endl;
+        cout << "13. Manage Pricing (Rule / Fare Ladder)" << endl;
+        cout << "14. Service Calendar (Running Days)" << endl;
+        cout << "15. **Switch User**" << endl; 
+        cout << "16. Exit System" << endl;
+        cout << "----------------------------------------------" << endl;
+        cout << "Enter your choice: ";
+    }
+};
+
+// --- NEW CLASS 10: Customer (Derived from User) ---
+class Customer : public User {
+public:
+    Customer(const string& u, const string& p) : User(u, p, "Customer") {}
+    
+    void displayMenu() const override {
+        cout << "\n==============================================" << endl;
+        cout << "🎫 **User Menu** 🎫" << endl;
+        cout << "==============================================" << endl;
+        cout << "1. Search Trains by Route" << endl;
+        cout << "2. **Book New Ticket (Multi-Group)**" << endl; // Updated for coordination
+        cout << "3. View Booking by PNR" << endl;
+        cout << "4. **Cancel Booking (with Refund)**" << endl; 
+        cout << "5. View Transaction History" << endl; 
+        cout << "6. **Switch User**" << endl; 
+        cout << "7. Exit System" << endl; 
+        cout << "----------------------------------------------" << endl;
+        cout << "Enter your choice: ";
+    }
+};
+
+// --- NEW CLASS 11: PaymentGateway (Mock Transaction) ---
+class PaymentGateway {
+public:
+    // Mock success/failure for transactional simulation
+    bool processPayment(Money amount) {
+        cout << "[Payment] Attempting payment of ₹" << amount << "... ";
+        bool success = InputCapture::getInstance().resolvePayment(rand() % 5 != 0); // 80% success rate
+        if (success) {
+            cout << "✅ SUCCESS." << endl;
+            return true;
+        } else {
+            cout << "❌ FAILED. (Simulated)" << endl;
+            return false;
+        }
+    }
+    
+    void processRefund(Money amount) {
+        cout << "[Payment] Processing refund of ₹" << amount << "... ✅ DONE." << endl;
+    }
+
+    // Mock Transaction logging (Simple Write-Ahead Log simulation)
+    // Format: ctime line, then |PNR|Action|Status|Train (train feeds the time-series rollup)
+    void logTransaction(const string& pnr, const string& action, const string& status, const string& tNum = "") {
+        ofstream logFile(TX_LOG_FILE, ios::app);
+        if (logFile.is_open()) {
+            time_t now = InputCapture::getInstance().now();
+            logFile << ctime(&now) << "|" << pnr << "|" << action << "|" << status;
+            if (!tNum.empty()) logFile << "|" << tNum;
+            logFile << endl;
+        }
+    }
+};
+
+
+// --- NEW CLASS 11a: RevenueAggregator (Columnar Aggregation Engine) ---
+// Bookings and per-train-date inventory are copied into flat columns (ids, date keys,
+// status codes, seats, fares in paise). Group-by scans run branch-free over those integer
+// columns (the per-group accumulation is a scatter, so it is not vectorized), and large scans
+// split across threads with per-thread partial sums merged at the end.
+enum BookingStatusCode : uint8_t { STATUS_CONFIRMED = 1, STATUS_WAITLIST = 2, STATUS_CANCELLED = 4, STATUS_OTHER = 8 };
+
+uint8_t bookingStatusCode(const string& status) {
+    if (status == "Confirmed") return STATUS_CONFIRMED;
+    if (status == "Waitlist") return STATUS_WAITLIST;
+    if (status == "Cancelled") return STATUS_CANCELLED;
+    return STATUS_OTHER;
+}
+
+struct AggregateRow {
+    string group;
+    long long bookings = 0;
+    long long seats = 0;
+    Money revenue;
+    long long capacity = 0;   // Seats offered in the date range (inventory)
+    double loadFactor = 0.0;  // seats / capacity
+};
+
+class RevenueAggregator {
+public:
+    enum class GroupBy { Train, Date, Route };
+
+private:
+    // Booking columns
+    vector<uint32_t> bTrain, bDate;
+    vector<int32_t> bDateKey, bSeats;
+    vector<uint8_t> bStatus;
+    vector<int64_t> bFarePaise;
+
+    // Inventory columns (one row per train-date)
+    vector<uint32_t> iTrain, iDate;
+    vector<int32_t> iDateKey, iCapacity;
+
+    // Dimensions
+    vector<string> trainNames, dateNames, routeNames;
+    vector<uint32_t> trainRoute;
+    unordered_map<string, uint32_t> trainIds, dateIds, routeIds;
+
+    static uint32_t intern(unordered_map<string, uint32_t>& ids, vector<string>& names, const string& key) {
+        auto it = ids.find(key);
+        if (it != ids.end()) return it->second;
+        uint32_t id = static_cast<uint32_t>(names.size());
+        ids.emplace(key, id);
+        names.push_back(key);
+        return id;
+    }
+
+    uint32_t trainIdFor(const string& tNum) {
+        uint32_t id = intern(trainIds, trainNames, tNum);
+        if (trainRoute.size() <= id) trainRoute.resize(id + 1, intern(routeIds, routeNames, "?"));
+        return id;
+    }
 
-    // Display
-    void displayPassenger() const {
-        cout << "    Name: " << name << ", Age: " << age 
-             << ", Gender: " << gender << endl;
+public:
+    void addTrain(const string& tNum, const string& src, const string& dest) {
+        uint32_t id = trainIdFor(tNum);
+        trainRoute[id] = intern(routeIds, routeNames, src + "->" + dest);
     }
 
-    // Serialization for File Persistence
-    string serialize() const {
-        // Format: Name|Age|Gender
-        return name + "|" + to_string(age) + "|" + gender;
+    void addInventory(const string& tNum, Date day, int capacity) {
+        iTrain.push_back(trainIdFor(tNum));
+        iDate.push_back(intern(dateIds, dateNames, day.toString()));
+        iDateKey.push_back(day.key());
+        iCapacity.push_back(capacity);
     }
-};
 
-// --- 2. SeatAllocation Structure (Data Management) ---
-struct SeatAllocation {
-    string date;
-    int availableSeats;
+    void addBooking(const string& tNum, const string& date, const string& status, int seats, Money fare) {
+        bTrain.push_back(trainIdFor(tNum));
+        bDate.push_back(intern(dateIds, dateNames, date));
+        bDateKey.push_back(dateSortKey(date));
+        bStatus.push_back(bookingStatusCode(status));
+        bSeats.push_back(seats);
+        bFarePaise.push_back(fare.toPaise());
+    }
 
-    string serialize() const {
-        return date + "|" + to_string(availableSeats);
+    void reserve(size_t bookingRows, size_t inventoryRows) {
+        bTrain.reserve(bookingRows); bDate.reserve(bookingRows); bDateKey.reserve(bookingRows);
+        bStatus.reserve(bookingRows); bSeats.reserve(bookingRows); bFarePaise.reserve(bookingRows);
+        iTrain.reserve(inventoryRows); iDate.reserve(inventoryRows);
+        iDateKey.reserve(inventoryRows); iCapacity.reserve(inventoryRows);
     }
-    
-    static SeatAllocation deserialize(const string& data) {
-        stringstream ss(data);
-        string segment;
-        vector<string> parts;
-        while (getline(ss, segment, '|')) {
-            parts.push_back(segment);
-        }
-        try {
-            if (parts.size() == 2) {
-                return {parts[0], stoi(parts[1])};
+
+    size_t bookingRows() const { return bFarePaise.size(); }
+
+    // Sums bookings/seats/revenue for rows whose status is in 'statusMask' and whose
+    // date key is within [fromKey, toKey]; capacity comes from inventory in that range.
+    vector<AggregateRow> aggregate(GroupBy groupBy, int32_t fromKey, int32_t toKey,
+                                   uint8_t statusMask = STATUS_CONFIRMED, unsigned threads = 0) const {
+        const vector<string>& names = (groupBy == GroupBy::Train) ? trainNames
+                                    : (groupBy == GroupBy::Date) ? dateNames : routeNames;
+        const size_t groups = names.size();
+        auto groupOf = [&](uint32_t train, uint32_t date) {
+            return (groupBy == GroupBy::Train) ? train : (groupBy == GroupBy::Date) ? date : trainRoute[train];
+        };
+
+        // Materialize the group column once so the hot loop is a plain indexed scatter
+        const size_t n = bFarePaise.size();
+        vector<uint32_t> group(n);
+        for (size_t i = 0; i < n; ++i) group[i] = groupOf(bTrain[i], bDate[i]);
+
+        if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+        if (n < 65536) threads = 1; // Not worth the thread start-up cost
+        struct Partial { vector<int64_t> revenue; vector<long long> seats, bookings; };
+        vector<Partial> partials(threads, Partial{vector<int64_t>(groups, 0), vector<long long>(groups, 0),
+                                                  vector<long long>(groups, 0)});
+
+        auto scan = [&](unsigned t) {
+            size_t begin = n * t / threads, end = n * (t + 1) / threads;
+            Partial& p = partials[t];
+            const uint32_t* g = group.data();
+            const int32_t* key = bDateKey.data();
+            const int32_t* seats = bSeats.data();
+            const uint8_t* status = bStatus.data();
+            const int64_t* fare = bFarePaise.data();
+            for (size_t i = begin; i < end; ++i) {
+                // Branch-free filter: 0/1 mask multiplies into the sums
+                int keep = ((status[i] & statusMask) != 0) & (key[i] >= fromKey) & (key[i] <= toKey);
+                p.revenue[g[i]] += fare[i] * keep;
+                p.seats[g[i]] += seats[i] * keep;
+                p.bookings[g[i]] += keep;
+            }
+        };
+        vector<thread> workers;
+        for (unsigned t = 1; t < threads; ++t) workers.emplace_back(scan, t);
+        scan(0);
+        for (auto& w : workers) w.join();
+
+        vector<AggregateRow> rows(groups);
+        for (size_t gi = 0; gi < groups; ++gi) rows[gi].group = names[gi];
+        for (const auto& p : partials) {
+            for (size_t gi = 0; gi < groups; ++gi) {
+                rows[gi].revenue += Money::fromPaise(p.revenue[gi]);
+                rows[gi].seats += p.seats[gi];
+                rows[gi].bookings += p.bookings[gi];
             }
-        } catch (const std::exception& e) {
-            cerr << "[Error] SeatAllocation deserialization failed: " << e.what() << endl;
         }
-        return {"", 0}; // Error case
+        for (size_t i = 0; i < iCapacity.size(); ++i) {
+            bool keep = (iDateKey[i] >= fromKey) & (iDateKey[i] <= toKey);
+            rows[groupOf(iTrain[i], iDate[i])].capacity += keep ? iCapacity[i] : 0;
+        }
+
+        // Drop empty groups and derive load factor
+        vector<AggregateRow> result;
+        for (auto& row : rows) {
+            if (row.bookings == 0 && row.capacity == 0) continue;
+            row.loadFactor = row.capacity ? static_cast<double>(row.seats) / row.capacity : 0.0;
+            result.push_back(row);
+        }
+        return result;
     }
 };
 
-// --- NEW STRUCT 3a: Stop (Schedule Detail) ---
-struct Stop {
-    string stationName;
-    string arrivalTime;
-    string departureTime;
-    // In a real system, this would also include distance/fare information.
+// --- NEW CLASS 11b: LiveAggregates (Incremental Dashboard Counters) ---
+// Running totals per (train, date) and per route, updated in O(1) by the booking,
+// cancellation and promotion paths so dashboards read them without scanning.
+// Revenue is the fare of currently confirmed bookings (matches the revenue report).
+struct LiveAggregate {
+    long long seatsSold = 0;
+    Money revenue;
+    long long cancellations = 0;
+    long long waitlistDepth = 0; // Waitlisted bookings (entries, not seats)
 };
 
-// --- NEW CLASS 3b: Route (Schedule/Timetable Abstraction) ---
-class Route {
+class LiveAggregates {
 private:
-    string sourceStation;
-    string destinationStation;
-    vector<Stop> schedule; // New schedule detail
-public:
-    Route(const string& src, const string& dest)
-        : sourceStation(src), destinationStation(dest) {
-        // Dummy schedule for demonstration
-        schedule.push_back({sourceStation, "N/A", "08:00"});
-        schedule.push_back({"MidPoint", "12:00", "12:15"});
-        schedule.push_back({destinationStation, "18:00", "N/A"});
+    unordered_map<string, LiveAggregate> byTrainDate; // Key: TrainNum|Date (same as waitlist)
+    unordered_map<string, LiveAggregate> byRoute;     // Key: Src->Dest
+
+    template <typename Fn>
+    void apply(const Train* train, const string& tNum, const string& date, Fn update) {
+        update(byTrainDate[tNum + "|" + date]);
+        if (train) update(byRoute[train->getSource() + "->" + train->getDestination()]);
     }
 
-    string getSource() const { return sourceStation; }
-    string getDestination() const { return destinationStation; }
+public:
+    void onConfirmed(const Train* train, const Booking& b) {
+        apply(train, b.getTrainNumber(), b.getDate(), [&b](LiveAggregate& a) {
+            a.seatsSold += b.getNumPassengers();
+            a.revenue += b.getTotalFare();
+        });
+    }
 
-    void displaySchedule() const {
-        cout << "        Schedule:" << endl;
-        for(const auto& s : schedule) {
-            cout << "        - " << s.stationName << " | Arr: " << s.arrivalTime << " | Dep: " << s.departureTime << endl;
-        }
+    void onWaitlisted(const Train* train, const Booking& b) {
+        apply(train, b.getTrainNumber(), b.getDate(), [](LiveAggregate& a) { a.waitlistDepth++; });
     }
 
-    // Serialization: Src|Dest
-    string serialize() const {
-        // Simplified serialization, ignoring full schedule for now
-        return sourceStation + "|" + destinationStation;
+    void onPromoted(const Train* train, const Booking& b) {
+        apply(train, b.getTrainNumber(), b.getDate(), [&b](LiveAggregate& a) {
+            a.waitlistDepth--;
+            a.seatsSold += b.getNumPassengers();
+            a.revenue += b.getTotalFare();
+        });
     }
-    static Route deserialize(const string& data) {
-        stringstream ss(data);
-        string src, dest;
-        getline(ss, src, '|');
-        getline(ss, dest, '|');
-        return Route(src, dest);
+
+    // 'previousStatus' is the booking status before cancellation (Confirmed/Waitlist)
+    void onCancelled(const Train* train, const Booking& b, const string& previousStatus) {
+        bool wasConfirmed = (previousStatus == "Confirmed");
+        apply(train, b.getTrainNumber(), b.getDate(), [&b, wasConfirmed](LiveAggregate& a) {
+            a.cancellations++;
+            if (wasConfirmed) {
+                a.seatsSold -= b.getNumPassengers();
+                a.revenue -= b.getTotalFare();
+            } else {
+                a.waitlistDepth--;
+            }
+        });
     }
-};
 
+    // Rebuild from loaded bookings (cancellations only count, they hold no seats)
+    void onLoaded(const Train* train, const Booking& b) {
+        if (b.getStatus() == "Confirmed") onConfirmed(train, b);
+        else if (b.getStatus() == "Waitlist") onWaitlisted(train, b);
+        else if (b.getStatus() == "Cancelled") {
+            apply(train, b.getTrainNumber(), b.getDate(), [](LiveAggregate& a) { a.cancellations++; });
+        }
+    }
 
-// --- 4. Train Base Class (Abstraction/Polymorphism) ---
-class Train {
-protected:
-    string trainNumber;
-    string trainName;
-    Route route; // Using the new Route class
-    int totalSeats;
-    double baseFare;
-    
-    vector<SeatAllocation> seatMap; 
+    LiveAggregate forTrainDate(const string& tNum, const string& date) const {
+        auto it = byTrainDate.find(tNum + "|" + date);
+        return it != byTrainDate.end() ? it->second : LiveAggregate();
+    }
 
-public:
-    // Constructor (Updated to use Route object)
-    Train(const string& num, const string& name, const Route& r, int seats, double fare)
-        : trainNumber(num), trainName(name), route(r), totalSeats(seats), baseFare(fare) {
-        time_t t = time(0);
-        tm* now = localtime(&t);
-        string today = to_string(now->tm_mon + 1) + "/" + to_string(now->tm_mday) + "/" + to_string(now->tm_year + 1900);
-        seatMap.push_back({today, seats});
+    LiveAggregate forRoute(const string& src, const string& dest) const {
+        auto it = byRoute.find(src + "->" + dest);
+        return it != byRoute.end() ? it->second : LiveAggregate();
     }
 
-    // Pure virtual function (Polymorphism)
-    virtual void displayDetails() const = 0; 
-    
-    // Virtual function to serialize class data
-    virtual string serialize() const = 0;
+    const unordered_map<string, LiveAggregate>& trainDates() const { return byTrainDate; }
+    const unordered_map<string, LiveAggregate>& routes() const { return byRoute; }
+};
 
-    // Getters
-    string getTrainNumber() const { return trainNumber; }
-    string getTrainName() const { return trainName; }
-    string getSource() const { return route.getSource(); }
-    string getDestination() const { return route.getDestination(); }
-    int getTotalSeats() const { return totalSeats; }
-    double getBaseFare() const { return baseFare; }
+// --- NEW CLASS 11c: TxRollup (Transaction Time-Series) ---
+// Streams transactions.log in 1 MB chunks, parsing records in place (string_view, no
+// per-line strings) into per-minute, per-train counters. The rollup and the log offset
+// it has consumed are persisted, so each run only parses what was appended since.
+// Log records are two lines: a ctime() timestamp, then |PNR|Action|Status[|Train].
+struct TxCounters {
+    uint32_t bookings = 0;
+    uint32_t cancellations = 0;
+    uint32_t paymentFailures = 0;
+};
 
-    // Seat management using date
-    int getAvailableSeats(const string& date) {
-        for (auto& alloc : seatMap) {
-            if (alloc.date == date) {
-                return alloc.availableSeats;
-            }
-        }
-        // If date not found, assume full availability and add the date
-        if (isValidDate(date)) {
-             seatMap.push_back({date, totalSeats});
-             return totalSeats;
+class TxRollup {
+private:
+    string rollupPath;
+    unsigned long long consumedOffset = 0;          // Bytes of the log already rolled up
+    map<pair<long long, string>, TxCounters> buckets; // (minute index, train) -> counters
+
+    static int parseInt(string_view s) {
+        int v = 0;
+        for (char c : s) {
+            if (c >= '0' && c <= '9') v = v * 10 + (c - '0');
         }
-        return -1; // Invalid date
+        return v;
     }
 
-    bool bookSeat(const string& date, int count = 1) {
-        for (auto& alloc : seatMap) {
-            if (alloc.date == date) {
-                if (alloc.availableSeats >= count) {
-                    alloc.availableSeats -= count;
-                    return true;
-                }
-                return false; // Not enough seats
-            }
-        }
-        // Date not found: treat as new date
-        if (isValidDate(date) && count <= totalSeats) {
-            seatMap.push_back({date, totalSeats - count});
-            return true;
+    // "Www Mmm dd hh:mm:ss yyyy" -> minutes since 1970-01-01 (local wall clock), -1 if not a timestamp
+    static long long parseCtimeMinute(string_view line) {
+        if (line.size() < 24 || line[13] != ':' || line[16] != ':') return -1;
+        static const char* months = "JanFebMarAprMayJunJulAugSepOctNovDec";
+        string_view mon = line.substr(4, 3);
+        int month = 0;
+        for (int i = 0; i < 12; ++i) {
+            if (mon == string_view(months + i * 3, 3)) month = i + 1;
         }
-        return false;
+        if (month == 0) return -1;
+        int day = parseInt(line.substr(8, 2));
+        int hour = parseInt(line.substr(11, 2));
+        int minute = parseInt(line.substr(14, 2));
+        int year = parseInt(line.substr(20, 4));
+        return daysFromCivil(year, month, day) * 1440 + hour * 60 + minute;
     }
-    
-    void cancelSeat(const string& date, int count = 1) {
-        for (auto& alloc : seatMap) {
-            if (alloc.date == date) {
-                alloc.availableSeats += count;
-                if (alloc.availableSeats > totalSeats) {
-                    alloc.availableSeats = totalSeats; 
-                }
-                return;
+
+    void load() {
+        ifstream in(rollupPath);
+        string line;
+        if (!getline(in, line) || line.compare(0, 11, "TXROLLUP|1|") != 0) return;
+        consumedOffset = stoull(line.substr(11));
+        while (getline(in, line)) {
+            // Format: Minute|Train|Bookings|Cancellations|PaymentFailures
+            stringstream ss(line);
+            string minute, train, b, c, f;
+            if (getline(ss, minute, '|') && getline(ss, train, '|') && getline(ss, b, '|') &&
+                getline(ss, c, '|') && getline(ss, f, '|')) {
+                TxCounters& counters = buckets[{stoll(minute), train}];
+                counters.bookings = static_cast<uint32_t>(stoul(b));
+                counters.cancellations = static_cast<uint32_t>(stoul(c));
+                counters.paymentFailures = static_cast<uint32_t>(stoul(f));
             }
         }
     }
 
-    // Serialize seat map (complex persistence part)
-    string serializeSeatMap() const {
-        string data = to_string(seatMap.size()) + ":";
-        for (const auto& alloc : seatMap) {
-            data += alloc.serialize() + ";";
+    void save() const {
+        ofstream out(rollupPath, ios::trunc);
+        out << "TXROLLUP|1|" << consumedOffset << "\n";
+        for (const auto& bucket : buckets) {
+            out << bucket.first.first << "|" << bucket.first.second << "|" << bucket.second.bookings << "|"
+                << bucket.second.cancellations << "|" << bucket.second.paymentFailures << "\n";
         }
-        return data; // Format: Count:Date1|Seats1;Date2|Seats2;
     }
 
-    // Deserialize seat map
-    void deserializeSeatMap(const string& data) {
-        seatMap.clear();
-        size_t count_end = data.find(':');
-        if (count_end == string::npos) return;
+public:
+    explicit TxRollup(const string& path) : rollupPath(path) { load(); }
 
-        string count_str = data.substr(0, count_end);
-        int count = 0;
-        try {
-            count = stoi(count_str);
-        } catch (...) {
-            return; // Crash defense
-        }
-        
-        string segment = data.substr(count_end + 1);
-        stringstream ss(segment);
-        string alloc_data;
-        
-        for (int i = 0; i < count && getline(ss, alloc_data, ';'); ++i) {
-            seatMap.push_back(SeatAllocation::deserialize(alloc_data));
+    // Rolls up log records appended since the last run. 'pnrTrain' resolves the train for
+    // older records that predate the train field. Returns the number of records added.
+    size_t update(const string& logPath, const unordered_map<string, string>& pnrTrain) {
+        ifstream log(logPath, ios::binary | ios::ate);
+        if (!log.is_open()) return 0;
+        unsigned long long logSize = static_cast<unsigned long long>(log.tellg());
+        if (logSize < consumedOffset) { // Log was truncated or rotated: start over
+            buckets.clear();
+            consumedOffset = 0;
         }
-    }
-    
-    // Virtual destructor
-    virtual ~Train() {}
-};
+        log.seekg(static_cast<streamoff>(consumedOffset));
 
-// --- 5. ExpressTrain Derived Class (Inheritance) ---
-class ExpressTrain : public Train {
-private:
-    bool hasPantryCar;
+        const size_t chunkSize = 1 << 20;
+        vector<char> chunk(chunkSize);
+        size_t carried = 0;            // Bytes of an incomplete record kept from the last chunk
+        long long lastMinute = -1;
+        size_t records = 0;
 
-public:
-    // Constructor (Updated to use Route object)
-    ExpressTrain(const string& num, const string& name, const Route& r, int seats, double f, bool pantry)
-        : Train(num, name, r, seats, f), hasPantryCar(pantry) {}
-
-    // Overridden function (Polymorphism)
-    void displayDetails() const override {
-        cout << "    Train Number: " << trainNumber << endl;
-        cout << "    Train Name: " << trainName << " (EXPRESS)" << endl;
-        cout << "    Route: " << route.getSource() << " -> " << route.getDestination() << endl;
-        cout << "    Total Seats: " << totalSeats << ", Base Fare: ₹" << fixed << setprecision(2) << baseFare << endl;
-        cout << "    Pantry Car: " << (hasPantryCar ? "Yes" : "No") << endl;
-        route.displaySchedule(); // Displaying schedule
-    }
-    
-    // Overridden serialization
-    string serialize() const override {
-        // Format: TYPE|Num|Name|RouteData|TotalSeats|BaseFare|Pantry|SeatMapData
-        return "EXPRESS|" + trainNumber + "|" + trainName + "|" + route.serialize() + "|" + 
-               to_string(totalSeats) + "|" + to_string(baseFare) + "|" + to_string(hasPantryCar) + "|" + serializeSeatMap();
-    }
-    
-    bool getPantryStatus() const { return hasPantryCar; }
-};
+        while (log) {
+            log.read(chunk.data() + carried, static_cast<streamsize>(chunk.size() - carried));
+            size_t filled = carried + static_cast<size_t>(log.gcount());
+            if (filled == carried) break;
 
-// --- NEW STRUCT 6a: WaitlistEntry ---
-struct WaitlistEntry {
-    string pnr;
-    string date;
-    int numSeats;
-    int rank; // Waitlist position
+            size_t pos = 0, recordStart = 0;
+            while (pos < filled) {
+                const char* nl = static_cast<const char*>(memchr(chunk.data() + pos, '\n', filled - pos));
+                if (!nl) break;
+                size_t end = static_cast<size_t>(nl - chunk.data());
+                string_view line(chunk.data() + pos, end - pos);
+                pos = end + 1;
 
-    string serialize() const {
-        return pnr + "|" + date + "|" + to_string(numSeats) + "|" + to_string(rank);
-    }
-};
+                if (line.empty() || line[0] != '|') {
+                    lastMinute = parseCtimeMinute(line);
+                    continue;
+                }
+                // Entry line: |PNR|Action|Status[|Train]
+                string_view fields[4];
+                size_t count = 0, start = 1;
+                while (count < 4) {
+                    size_t bar = line.find('|', start);
+                    fields[count++] = line.substr(start, bar == string_view::npos ? string_view::npos : bar - start);
+                    if (bar == string_view::npos) break;
+                    start = bar + 1;
+                }
+                recordStart = pos; // Both lines of this record are consumed
+                if (lastMinute < 0 || count < 2) continue;
 
-// --- 6. Booking/Ticket Class ---
-class Booking {
-private:
-    string pnrNumber; 
-    string trainNumber;
-    string dateOfJourney;
-    vector<Passenger> passengers;
-    double totalFare;
-    string status; // Confirmed/Cancelled/Waitlist
+                string_view action = fields[1];
+                bool booked = (action == "PAYMENT_SUCCESS");
+                bool cancelled = (action.substr(0, 20) == "CANCELLATION_SUCCESS");
+                bool failed = (action == "PAYMENT_FAILED");
+                if (!booked && !cancelled && !failed) continue;
 
-public:
-    // Constructor
-    Booking(const string& pnr, const string& tNum, const string& date, const vector<Passenger>& p_list, double fare, const string& initialStatus = "Confirmed")
-        : pnrNumber(pnr), trainNumber(tNum), dateOfJourney(date), passengers(p_list), totalFare(fare), status(initialStatus) {}
+                string train = (count == 4) ? string(fields[3]) : "";
+                if (train.empty()) {
+                    auto it = pnrTrain.find(string(fields[0]));
+                    train = (it != pnrTrain.end()) ? it->second : "?";
+                }
+                TxCounters& counters = buckets[{lastMinute, train}];
+                counters.bookings += booked;
+                counters.cancellations += cancelled;
+                counters.paymentFailures += failed;
+                records++;
+            }
 
-    // Default Constructor for File Loading
-    Booking() : pnrNumber(""), trainNumber(""), dateOfJourney(""), totalFare(0.0), status("") {}
+            // Keep the unfinished record (timestamp line and/or partial entry) for the next chunk
+            consumedOffset += recordStart;
+            carried = filled - recordStart;
+            memmove(chunk.data(), chunk.data() + recordStart, carried);
+            if (carried == chunk.size()) break; // Malformed: a single record larger than a chunk
+        }
 
-    // Getters
-    string getPNR() const { return pnrNumber; }
-    string getTrainNumber() const { return trainNumber; }
-    string getDate() const { return dateOfJourney; }
-    double getTotalFare() const { return totalFare; }
-    string getStatus() const { return status; }
-    
-    // Mutator
-    void setStatus(const string& newStatus) { status = newStatus; }
+        save();
+        return records;
+    }
 
-    // Display (Also handles viewing confirmed/waitlist status)
-    void displayBooking() const {
-        cout << "\n    --- Booking Details (PNR: " << pnrNumber << ") ---" << endl;
-        cout << "    Train Number: " << trainNumber << ", Date: " << dateOfJourney << endl;
-        cout << "    Booking Status: " << status << endl;
-        cout << "    Total Fare Paid: ₹" << fixed << setprecision(2) << totalFare << endl;
-        cout << "    Passengers (" << passengers.size() << "):" << endl;
-        for (const auto& p : passengers) {
-            p.displayPassenger();
+    // Counters summed into 'bucketMinutes'-wide buckets for trains accepted by 'match'
+    template <typename Match>
+    map<long long, TxCounters> series(Match match, int bucketMinutes) const {
+        map<long long, TxCounters> result;
+        for (const auto& bucket : buckets) {
+            if (!match(bucket.first.second)) continue;
+            long long start = bucket.first.first - bucket.first.first % max(1, bucketMinutes);
+            TxCounters& sum = result[start];
+            sum.bookings += bucket.second.bookings;
+            sum.cancellations += bucket.second.cancellations;
+            sum.paymentFailures += bucket.second.paymentFailures;
         }
-        cout << "    -------------------------------------------------" << endl;
-    }
-    
-    int getNumPassengers() const {
-        return passengers.size();
+        return result;
     }
-    
-    // Serialization for File Persistence
-    string serialize() const {
-        string p_data = "";
-        for (const auto& p : passengers) {
-            p_data += p.serialize() + "&"; // Passenger separator
-        }
-        if (!p_data.empty()) p_data.pop_back(); // Remove trailing separator
 
-        // Format: PNR|TrainNum|Date|Fare|Status|PassengerCount|PassengerData
-        return pnrNumber + "|" + trainNumber + "|" + dateOfJourney + "|" + to_string(totalFare) + "|" + status + 
-               "|" + to_string(passengers.size()) + "|" + p_data;
+    static string formatMinute(long long minuteIndex) {
+        int y, m, d;
+        civilFromDays(minuteIndex / 1440, y, m, d);
+        char text[32];
+        snprintf(text, sizeof(text), "%04d-%02d-%02d %02d:%02d", y, m, d,
+                 static_cast<int>(minuteIndex % 1440 / 60), static_cast<int>(minuteIndex % 60));
+        return text;
     }
+};
 
-    // Deserialization (Static or standalone helper recommended for production)
-    static Booking deserialize(const string& data) {
-        stringstream ss(data);
-        string segment;
+// --- NEW CLASS 11d: DataFileMigrator (Version-1 -> Version-2 Data Files) ---
+// Streams a headerless (version-1) data file line by line into <file>.migrating as
+// version-2 records, then renames it over the original, which is kept as <file>.v1. Every positional legacy layout
+// is decoded here and only here, so the loaders only ever read tagged, named fields.
+class DataFileMigrator {
+private:
+    static vector<string> splitPipes(const string& line) {
         vector<string> parts;
-        while (getline(ss, segment, '|')) {
-            parts.push_back(segment);
-        }
+        stringstream ss(line);
+        string segment;
+        while (getline(ss, segment, '|')) parts.push_back(segment);
+        return parts;
+    }
 
-        if (parts.size() < 7) return Booking(); // Invalid format
-        
-        Booking b;
-        try {
-            b.pnrNumber = parts[0];
-            b.trainNumber = parts[1];
-            b.dateOfJourney = parts[2];
-            b.totalFare = stod(parts[3]);
-            b.status = parts[4];
-            int p_count = stoi(parts[5]);
-            string p_data_str = parts[6];
-
-            stringstream pss(p_data_str);
-            string p_segment;
-            
-            // Deserialize Passengers
-            for (int i = 0; i < p_count && getline(pss, p_segment, '&'); ++i) {
-                stringstream psss(p_segment);
-                string p_part;
-                vector<string> p_parts;
-                while(getline(psss, p_part, '|')) {
-                    p_parts.push_back(p_part);
-                }
-                if (p_parts.size() == 3) {
-                    b.passengers.emplace_back(p_parts[0], stoi(p_parts[1]), p_parts[2]);
-                }
-            }
-        } catch (const std::exception& e) {
-            cerr << "[Error] Booking deserialization failed: " << e.what() << ". Skipping record." << endl;
-            return Booking(); // Return empty booking on exception
+    static string joinFrom(const vector<string>& parts, size_t first) {
+        string joined;
+        for (size_t i = first; i < parts.size(); ++i) joined += (i > first ? "|" : "") + parts[i];
+        return joined;
+    }
+
+    // STATIONS|Name|...  TIMETABLE|Id|Stops
+    // TYPE|Num|Name|Src|Dest[@Timetable]|Seats|Fares|Pantry[,Premium]|[Pricing|][CAL:..|]SeatMap
+    // (the seat map itself contains '|', so it is everything after the optional fields)
+    static bool migrateTrainLine(const string& line, RecordWriter& out) {
+        vector<string> parts = splitPipes(line);
+        if (parts.empty()) return false;
+        if (parts[0] == "STATIONS") {
+            for (size_t i = 1; i < parts.size(); ++i) out.write("STATION", {parts[i]});
+            return true;
         }
-        return b;
+        if (parts[0] == "TIMETABLE") {
+            if (parts.size() != 3) return false;
+            out.write("TIMETABLE", {parts[1], parts[2]});
+            return true;
+        }
+        TrainType type;
+        if (!parseTrainType(parts[0], type) || parts.size() < 9) return false;
+        string dest = parts[4], timetable;
+        size_t at = dest.find('@');
+        if (at != string::npos) {
+            timetable = dest.substr(at + 1);
+            dest.erase(at);
+        }
+        size_t comma = parts[7].find(',');
+        string pantry = parts[7].substr(0, 1);
+        string premium = (comma != string::npos) ? parts[7].substr(comma + 1) : "0";
+        Money fare;
+        string fares = (parts[6].find('=') == string::npos && Money::parse(parts[6], fare)) ? fare.toString() : parts[6];
+        size_t f = 8;
+        string pricing = (parts[f].find('#') != string::npos) ? parts[f++] : "";
+        string calendar = (parts.size() > f && parts[f].compare(0, 4, "CAL:") == 0) ? parts[f++] : "";
+        out.write("TRAIN", {parts[0], parts[1], parts[2], parts[3], dest, timetable, parts[5], fares,
+                            pantry, premium, pricing, calendar, joinFrom(parts, f)});
+        return true;
     }
-};
 
-// --- NEW CLASS 7: PNRGenerator ---
-class PNRGenerator {
-private:
-    long long currentPNR = 100000000000;
-    
-    void savePNR() const {
-        ofstream pnrFile(PNR_FILE);
-        if (pnrFile.is_open()) {
-            pnrFile << currentPNR;
-            pnrFile.close();
+    // PNR|Train|Date|[Class|]Fare|Status|Count|Name|Age|Gender[&Name|Age|Gender...]
+    // The passenger list was written with '|' inside it, so it is everything after Count.
+    static bool migrateBookingLine(const string& line, RecordWriter& out) {
+        vector<string> parts = splitPipes(line);
+        int cls = CLASS_SL;
+        size_t f = (parts.size() > 3 && parseCoachClass(parts[3], cls)) ? 4 : 3;
+        Money fare;
+        if (parts.size() < f + 3 || parts[0].empty() || !Money::parse(parts[f], fare)) return false;
+        out.write("BOOKING", {parts[0], parts[1], parts[2], coachClassName(cls), fare.toString(), parts[f + 1],
+                              joinFrom(parts, f + 3)});
+        return true;
+    }
+
+    // Role|Username|Password
+    static bool migrateUserLine(const string& line, RecordWriter& out) {
+        vector<string> parts = splitPipes(line);
+        if (parts.size() != 3) return false;
+        out.write("USER", parts);
+        return true;
+    }
+
+public:
+    // Schema lines for each data file kind; saveData writes the same ones
+    static void writeSchemas(RecordWriter& out, const string& kind) {
+        if (kind == "trains") {
+            out.schema("STATION", {"name"});
+            out.schema("TIMETABLE", {"id", "stops"});
+            out.schema("TRAIN", Train::recordSchema());
+        } else if (kind == "bookings") {
+            out.schema("BOOKING", Booking::recordSchema());
+        } else if (kind == "users") {
+            out.schema("USER", User::recordSchema());
         }
     }
 
-    void loadPNR() {
-        ifstream pnrFile(PNR_FILE);
-        if (pnrFile.is_open()) {
-            // FIX: Robust check to handle empty or malformed file content
-            string pnr_str;
-            if (pnrFile >> pnr_str && !pnr_str.empty()) {
-                try {
-                    currentPNR = stoll(pnr_str);
-                } catch (const std::exception& e) {
-                    // Fallback if file content is non-numeric or malformed
-                    currentPNR = 100000000000;
-                    cerr << "[Warning] PNR file corrupted (" << e.what() << "). Resetting counter." << endl;
-                }
+    // Upgrades 'path' in place if it is a version-1 file. Returns false only if a legacy
+    // file could not be rewritten (the original is then left untouched).
+    static bool migrateIfLegacy(const string& path, const string& kind) {
+        ifstream in(path);
+        if (!in.is_open()) return true;
+        RecordReader reader(in);
+        if (!reader.isLegacy()) return true;
+
+        string tempPath = path + ".migrating";
+        ofstream out(tempPath, ios::trunc);
+        if (!out.is_open()) {
+            cerr << "[Migrate] Cannot write " << tempPath << ". Keeping " << path << " as version 1." << endl;
+            return false;
+        }
+        RecordWriter writer(out, kind);
+        writeSchemas(writer, kind);
+        auto migrateLine = kind == "trains" ? migrateTrainLine : kind == "bookings" ? migrateBookingLine : migrateUserLine;
+        size_t migrated = 0, dropped = 0;
+        string line;
+        while (reader.nextLine(line)) {
+            if (line.empty()) continue;
+            if (migrateLine(line, writer)) {
+                migrated++;
+            } else {
+                dropped++;
+                cerr << "[Migrate] Dropping unreadable " << kind << " record: " << line.substr(0, 30) << "..." << endl;
             }
         }
-        if (currentPNR < 100000000000) {
-            currentPNR = 100000000000;
+        in.close();
+        out.close();
+        // The original is kept as <file>.v1, so dropped records can still be recovered by hand
+        string backupPath = path + ".v1";
+        remove(backupPath.c_str()); // rename does not replace an existing file everywhere
+        if (!out || rename(path.c_str(), backupPath.c_str()) != 0) {
+            cerr << "[Migrate] Cannot back up " << path << " to " << backupPath << ". Keeping it as version 1." << endl;
+            remove(tempPath.c_str());
+            return false;
         }
+        if (rename(tempPath.c_str(), path.c_str()) != 0) {
+            cerr << "[Migrate] Cannot replace " << path << ". Keeping it as version 1." << endl;
+            rename(backupPath.c_str(), path.c_str());
+            remove(tempPath.c_str());
+            return false;
+        }
+        cout << "[Migrate] " << path << ": version 1 -> " << DATA_FILE_VERSION << " (" << migrated << " line(s)"
+             << (dropped ? ", " + to_string(dropped) + " dropped" : string()) << "), original kept as "
+             << backupPath << endl;
+        return true;
     }
-    
+
+    static bool migrateAll() {
+        bool ok = migrateIfLegacy(TRAIN_FILE, "trains");
+        ok = migrateIfLegacy(BOOKING_FILE, "bookings") && ok;
+        return migrateIfLegacy(USER_FILE, "users") && ok;
+    }
+};
+
+// --- NEW CLASS 11e: LazyBookingStore (bookings faulted in per train on first access) ---
+// Lazy startup reads bookings_data.txt once and keeps only PNR -> (train, byte offset).
+// A train's bookings are parsed the first time anything touches that train. The optional
+// prefetcher parses the remaining trains on a background thread into a staging map that only
+// the manager's thread drains, so the manager itself stays single-threaded.
+enum class BookingLoadMode { Eager, Lazy, LazyPrefetch };
+
+class LazyBookingStore {
 public:
-    PNRGenerator() {
-        loadPNR();
+    struct PnrRef {
+        string trainNumber;
+        streamoff offset; // Start of the BOOKING line in the current bookings file
+    };
+
+private:
+    vector<string> schema; // Booking columns as declared by the indexed file
+    unordered_map<string, vector<string>> trainPnrs; // Unloaded train -> its PNRs, file order
+    unordered_map<string, PnrRef> pnrRefs; // Every PNR still on disk only
+    vector<pair<PnrRef*, streamoff>> relocations; // New offsets while saveData rewrites the file
+    size_t faultedTrains = 0, faultedBookings = 0, prefetchedTrains = 0;
+    double faultMs = 0.0;
+
+    mutex stagingLock;
+    unordered_map<string, vector<Booking>> staged; // Parsed ahead by the prefetcher, not yet adopted
+    thread prefetcher;
+    atomic<bool> stopPrefetch{false};
+
+    // Parses the BOOKING lines at 'offsets'; false if any of them is missing or not a booking
+    static bool readRecords(ifstream& file, const vector<string>& names, const vector<streamoff>& offsets,
+                            vector<Booking>& out) {
+        DataRecord rec;
+        rec.names = &names;
+        string line;
+        for (streamoff offset : offsets) {
+            file.clear();
+            file.seekg(offset);
+            if (!getline(file, line)) return false;
+            splitRecordFields(line, rec.fields);
+            if (rec.tag() != "BOOKING") return false;
+            out.push_back(Booking::fromRecord(rec));
+        }
+        return true;
     }
 
-    string generate() {
-        currentPNR++;
-        savePNR();
-        return to_string(currentPNR);
+    vector<streamoff> offsetsOf(const vector<string>& pnrs) const {
+        vector<streamoff> offsets;
+        offsets.reserve(pnrs.size());
+        for (const auto& pnr : pnrs) offsets.push_back(pnrRefs.at(pnr).offset);
+        return offsets;
     }
-};
 
-// --- NEW CLASS 8: User Base Class (Polymorphism) ---
-class User {
-protected:
-    string username;
-    string password;
-    string role;
 public:
-    User(const string& u, const string& p, const string& r) : username(u), password(p), role(r) {}
-    
-    virtual void displayMenu() const = 0;
-    string getUsername() const { return username; }
-    string getRole() const { return role; }
-    
-    // Only checks the password argument
-    bool authenticate(const string& inputPassword) const { return password == inputPassword; }
-    
-    // Virtual serialization for persistence
-    virtual string serialize() const = 0;
-    virtual ~User() {}
-};
+    LazyBookingStore() = default;
+    LazyBookingStore(const LazyBookingStore&) = delete;
+    LazyBookingStore& operator=(const LazyBookingStore&) = delete;
 
-// --- NEW CLASS 9: Admin (Derived from User) ---
-class Admin : public User {
-public:
-    Admin(const string& u, const string& p) : User(u, p, "Admin") {}
-    
-    void displayMenu() const override {
-        cout << "\n==============================================" << endl;
-        cout << "🔒 **Admin Menu** 🔒" << endl;
-        cout << "==============================================" << endl;
-        cout << "1. View All Trains (Basic Details)" << endl;
-        cout << "2. View Train Availability by Date" << endl;
-        cout << "3. **Add New Express Train**" << endl;
-        cout << "4. Remove Train" << endl;
-        cout << "5. **View All Bookings**" << endl; 
-        cout << "6. Process Waitlist (Manual)" << endl;
-        cout << "7. **Switch User**" << endl; 
-        cout << "8. Exit System" << endl;
-        cout << "----------------------------------------------" << endl;
-        cout << "Enter your choice: ";
+    ~LazyBookingStore() {
+        stopPrefetch = true;
+        if (prefetcher.joinable()) prefetcher.join();
     }
-    
-    string serialize() const override {
-        return "Admin|" + username + "|" + password;
+
+    // One pass over the bookings file keeping only PNR, train and offset. Returns false (and
+    // indexes nothing) if the file declares a booking layout other than the current one; the
+    // caller then loads eagerly, since saveData copies unloaded records through verbatim.
+    bool buildIndex(const string& path, LoadPhaseStats& phase) {
+        ifstream file(path);
+        RecordReader reader(file);
+        DataRecord rec;
+        while (reader.next(rec)) {
+            if (rec.tag() != "BOOKING") continue;
+            if (!rec.names || *rec.names != Booking::recordSchema()) {
+                trainPnrs.clear();
+                pnrRefs.clear();
+                return false;
+            }
+            const string& pnr = rec.get("pnr");
+            const string& tNum = rec.get("train");
+            trainPnrs[tNum].push_back(pnr);
+            pnrRefs[pnr] = {tNum, static_cast<streamoff>(reader.getRecordOffset())};
+            phase.records++;
+        }
+        schema = Booking::recordSchema();
+        phase.bytes = reader.getBytesRead();
+        return true;
     }
-};
 
-// --- NEW CLASS 10: Customer (Derived from User) ---
-class Customer : public User {
-public:
-    Customer(const string& u, const string& p) : User(u, p, "Customer") {}
-    
-    void displayMenu() const override {
-        cout << "\n==============================================" << endl;
-        cout << "🎫 **User Menu** 🎫" << endl;
-        cout << "==============================================" << endl;
-        cout << "1. Search Trains by Route" << endl;
-        cout << "2. **Book New Ticket (Multi-Group)**" << endl; // Updated for coordination
-        cout << "3. View Booking by PNR" << endl;
-        cout << "4. **Cancel Booking (with Refund)**" << endl; 
-        cout << "5. View Transaction History" << endl; 
-        cout << "6. **Switch User**" << endl; 
-        cout << "7. Exit System" << endl; 
-        cout << "----------------------------------------------" << endl;
-        cout << "Enter your choice: ";
+    // Parses every unloaded train on a background thread, largest first. Results wait in the
+    // staging map until fault() adopts them. The file is opened here, before the thread starts,
+    // so the offsets and the handle both describe the file as indexed; the handle stays valid
+    // when saveData later replaces the file by rename.
+    void startPrefetch(const string& path) {
+        vector<pair<string, vector<streamoff>>> jobs;
+        for (const auto& train : trainPnrs) jobs.emplace_back(train.first, offsetsOf(train.second));
+        sort(jobs.begin(), jobs.end(), [](const auto& a, const auto& b) { return a.second.size() > b.second.size(); });
+        ifstream indexedFile(path);
+        if (!indexedFile.is_open()) return; // Nothing to prefetch from; fault() reports per train
+        prefetcher = thread([this, file = move(indexedFile), jobs = move(jobs)]() mutable {
+            for (const auto& job : jobs) {
+                if (stopPrefetch) return;
+                vector<Booking> parsed;
+                if (!readRecords(file, schema, job.second, parsed)) continue; // fault() will report it
+                lock_guard<mutex> guard(stagingLock);
+                staged.emplace(job.first, move(parsed));
+            }
+        });
     }
-    
-    string serialize() const override {
-        return "Customer|" + username + "|" + password;
+
+    bool isResident(const string& tNum) const { return trainPnrs.find(tNum) == trainPnrs.end(); }
+    bool hasUnloaded() const { return !trainPnrs.empty(); }
+    size_t unloadedCount() const { return pnrRefs.size(); }
+
+    const PnrRef* find(const string& pnr) const {
+        auto it = pnrRefs.find(pnr);
+        return it != pnrRefs.end() ? &it->second : nullptr;
     }
-};
 
-// --- NEW CLASS 11: PaymentGateway (Mock Transaction) ---
-class PaymentGateway {
-public:
-    // Mock success/failure for transactional simulation
-    bool processPayment(double amount) {
-        cout << "[Payment] Attempting payment of ₹" << fixed << setprecision(2) << amount << "... ";
-        if (rand() % 5 != 0) { // 80% success rate
-            cout << "✅ SUCCESS." << endl;
-            return true;
-        } else {
-            cout << "❌ FAILED. (Simulated)" << endl;
-            return false;
+    template <typename Visit>
+    void forEachUnloaded(Visit visit) const {
+        for (const auto& entry : pnrRefs) visit(entry.first, entry.second);
+    }
+
+    vector<string> unloadedTrains() const {
+        vector<string> tNums;
+        for (const auto& train : trainPnrs) tNums.push_back(train.first);
+        return tNums;
+    }
+
+    // Moves the bookings of 'tNum' (file order) into 'out' and forgets their offsets.
+    // Returns false if the train is already resident.
+    bool fault(const string& path, const string& tNum, vector<Booking>& out) {
+        auto train = trainPnrs.find(tNum);
+        if (train == trainPnrs.end()) return false;
+        auto start = chrono::steady_clock::now();
+        bool adopted = false;
+        {
+            lock_guard<mutex> guard(stagingLock);
+            auto ready = staged.find(tNum);
+            if (ready != staged.end()) {
+                out = move(ready->second);
+                staged.erase(ready);
+                adopted = true;
+            }
+        }
+        if (!adopted) {
+            ifstream file(path);
+            if (!readRecords(file, schema, offsetsOf(train->second), out)) {
+                cerr << "[Error] Bookings of " << tNum << " could not be re-read from " << path
+                     << ". Keeping " << out.size() << " of " << train->second.size() << "." << endl;
+            }
         }
+        for (const auto& pnr : train->second) pnrRefs.erase(pnr);
+        faultedBookings += out.size();
+        faultedTrains++;
+        if (adopted) prefetchedTrains++;
+        trainPnrs.erase(train);
+        faultMs += elapsedMsSince(start);
+        return true;
     }
-    
-    void processRefund(double amount) {
-        cout << "[Payment] Processing refund of ₹" << fixed << setprecision(2) << amount << "... ✅ DONE." << endl;
+
+    // Parses a single unloaded booking without faulting its train in (read-only lookups)
+    bool peek(const string& path, const string& pnr, Booking& out) const {
+        const PnrRef* ref = find(pnr);
+        if (!ref) return false;
+        ifstream file(path);
+        vector<Booking> one;
+        if (!readRecords(file, schema, {ref->offset}, one)) return false;
+        out = move(one.front());
+        return true;
     }
 
-    // Mock Transaction logging (Simple Write-Ahead Log simulation)
-    void logTransaction(const string& pnr, const string& action, const string& status) {
-        ofstream logFile(TX_LOG_FILE, ios::app);
-        if (logFile.is_open()) {
-            time_t now = time(0);
-            logFile << ctime(&now) << "|" << pnr << "|" << action << "|" << status << endl;
+    // saveData: appends the still-unloaded records of 'fromPath' verbatim to 'out'. The new
+    // offsets take effect on commitRelocation(), once the rewritten file has replaced the old one.
+    bool copyUnloaded(const string& fromPath, ofstream& out) {
+        relocations.clear();
+        ifstream file(fromPath);
+        string line;
+        for (const auto& train : trainPnrs) {
+            for (const auto& pnr : train.second) {
+                PnrRef& ref = pnrRefs.at(pnr);
+                file.clear();
+                file.seekg(ref.offset);
+                if (!getline(file, line)) return false;
+                relocations.emplace_back(&ref, static_cast<streamoff>(out.tellp()));
+                out << line << '\n';
+            }
         }
+        return static_cast<bool>(out);
+    }
+
+    void commitRelocation() {
+        for (auto& moved : relocations) moved.first->offset = moved.second;
+        relocations.clear();
     }
-};
 
+    string describe() const {
+        stringstream ss;
+        ss << pnrRefs.size() << " booking(s) of " << trainPnrs.size() << " train(s) still on disk, "
+           << faultedBookings << " faulted in from " << faultedTrains << " train(s) (" << prefetchedTrains
+           << " prefetched) in " << fixed << setprecision(2) << faultMs << " ms";
+        return ss.str();
+    }
+};
 
 // --- 12. RailwayManager Class (Singleton/System) ---
 // Handles all data management, persistence, and core logic.
 class RailwayManager {
 private:
-    vector<Train*> trains; 
-    vector<Booking> bookings; 
-    vector<User*> users; 
+    vector<Train, TaggedAllocator<Train, MemTag::Trains>> trains; // Contiguous fleet; Train* into it are short-lived
+    vector<Booking, TaggedAllocator<Booking, MemTag::Bookings>> bookings; 
+    vector<User*, TaggedAllocator<User*, MemTag::Users>> users; 
     PNRGenerator pnrGenerator; 
     PaymentGateway paymentGateway; // New Payment Gateway instance
-    map<string, vector<WaitlistEntry>> waitlist; // Key: TrainNum|Date -> List of entries
+    WaitlistMap waitlist; // Key: TrainNum|Date -> List of entries
+    LiveAggregates liveAggregates; // Dashboard counters kept in step with bookings
+    FareQuoteCache quoteCache; // Group quotes, invalidated by per-train-date pricing versions
+    unordered_map<string, vector<size_t>> bookingIndex; // Key: TrainNum|Date -> positions in bookings
+    LazyBookingStore lazyBookings; // Bookings not yet faulted in (lazy startup only)
+
+    static BookingLoadMode& loadMode() {
+        static BookingLoadMode mode = BookingLoadMode::Eager;
+        return mode;
+    }
+
+    // Bookings are only ever appended, so positions stay valid
+    void indexBooking(size_t pos) {
+        bookingIndex[bookings[pos].getTrainNumber() + "|" + bookings[pos].getDate()].push_back(pos);
+    }
+
+    // Lazy startup: parses the bookings of 'tNum' on first access and rebuilds their index
+    // entries, live aggregates and waitlist exactly as the eager load does
+    void ensureBookingsLoaded(const string& tNum) {
+        if (lazyBookings.isResident(tNum)) return;
+        vector<Booking> loaded;
+        if (!lazyBookings.fault(BOOKING_FILE, tNum, loaded)) return;
+        const Train* train = findTrain(tNum);
+        for (auto& loadedBooking : loaded) {
+            bookings.push_back(move(loadedBooking));
+            indexBooking(bookings.size() - 1);
+            liveAggregates.onLoaded(train, bookings.back());
+            if (bookings.back().getStatus() == "Waitlist") placeOnWaitlist(bookings.back(), false);
+        }
+    }
+
+    // Reports and digests cover every booking
+    void ensureAllBookingsLoaded() {
+        for (const auto& tNum : lazyBookings.unloadedTrains()) ensureBookingsLoaded(tNum);
+    }
 
     // Private Constructor for Singleton
     RailwayManager() {
@@ -580,8 +3536,8 @@ private:
     // Train lookup helper
     Train* findTrain(const string& tNum) {
         for (auto& train : trains) {
-            if (train->getTrainNumber() == tNum) {
-                return train;
+            if (train.getTrainNumber() == tNum) {
+                return &train;
             }
         }
         return nullptr;
@@ -591,45 +3547,57 @@ private:
 
     // Finds a mutable reference to the booking given a PNR
     Booking* findBooking(const string& pnr) {
+        if (!pnrGenerator.mayExist(pnr)) return nullptr;
+        if (const LazyBookingStore::PnrRef* ref = lazyBookings.find(pnr)) {
+            string tNum = ref->trainNumber; // 'ref' is dropped when the train is faulted in
+            ensureBookingsLoaded(tNum);
+        }
         auto it = find_if(bookings.begin(), bookings.end(), 
                           [&pnr](const Booking& b){ return b.getPNR() == pnr; });
         return (it != bookings.end()) ? &(*it) : nullptr;
     }
 
-    void placeOnWaitlist(const Booking& newBooking) {
+    void placeOnWaitlist(const Booking& newBooking, bool announce = true) {
         string key = newBooking.getTrainNumber() + "|" + newBooking.getDate();
         
         WaitlistEntry entry;
         entry.pnr = newBooking.getPNR();
         entry.date = newBooking.getDate();
         entry.numSeats = newBooking.getNumPassengers();
+        entry.coachClass = newBooking.getCoachClass();
         entry.rank = waitlist[key].empty() ? 1 : waitlist[key].back().rank + 1;
 
         waitlist[key].push_back(entry);
         
-        cout << "\n✅ Booking **" << entry.pnr << "** placed on Waitlist (WL #" << entry.rank << ")." << endl;
+        if (announce) cout << "\n✅ Booking **" << entry.pnr << "** placed on Waitlist (WL #" << entry.rank << ")." << endl;
     }
 
-    void promoteWaitlist(const string& date, Train* train, int availableSeats) {
+    // Promotes waitlisted bookings of class 'cls' into its 'availableSeats' free seats
+    void promoteWaitlist(const string& date, Train* train, int cls, int availableSeats) {
         string key = train->getTrainNumber() + "|" + date;
+        Date day = Date::parseOr(date);
         if (!waitlist.count(key) || waitlist[key].empty() || availableSeats <= 0) return;
 
         int seatsToPromote = availableSeats;
         
         // Use a temporary list for promotion to avoid modifying the map while iterating
-        vector<WaitlistEntry> remainingWL;
+        WaitlistQueue remainingWL;
         bool promoted = false;
 
         for (const auto& entry : waitlist[key]) {
-            if (seatsToPromote >= entry.numSeats) {
+            if (entry.coachClass != cls) {
+                remainingWL.push_back(entry); // Waiting on another class
+            } else if (seatsToPromote >= entry.numSeats) {
                 // Promote this entire entry
                 Booking* booking = findBooking(entry.pnr);
                 if (booking && booking->getStatus() == "Waitlist") {
                     // 1. Commit provisional seat (uses bookSeat logic to consume newly available slot)
-                    if (train->bookSeat(date, entry.numSeats)) {
+                    if (train->bookSeat(day, entry.numSeats, cls)) {
                         // 2. Update booking status
                         booking->setStatus("Confirmed");
-                        cout << "\n🌟 PROMOTION: PNR " << entry.pnr << " CONFIRMED (" << entry.numSeats << " seats) from WL #" << entry.rank << "!" << endl;
+                        liveAggregates.onPromoted(train, *booking);
+                        cout << "\n🌟 PROMOTION: PNR " << entry.pnr << " CONFIRMED (" << entry.numSeats << " " << coachClassName(cls)
+                             << " seats) from WL #" << entry.rank << "!" << endl;
                         seatsToPromote -= entry.numSeats;
                         promoted = true;
                     } else {
@@ -653,38 +3621,35 @@ private:
 
 
     // --- File Persistence Implementation ---
+    // All three files are versioned record files (see RecordWriter); legacy files are
+    // upgraded by DataFileMigrator at the start of loadData.
     void saveUsers() const {
         ofstream userFile(USER_FILE);
         if (userFile.is_open()) {
+            RecordWriter out(userFile, "users");
+            DataFileMigrator::writeSchemas(out, "users");
             for (const auto& user : users) {
-                userFile << user->serialize() << "\n";
+                out.write("USER", user->recordFields());
             }
             userFile.close();
         }
     }
 
-    User* deserializeUser(const string& line) {
-        stringstream ss(line);
-        string segment;
-        vector<string> parts;
-        while (getline(ss, segment, '|')) {
-            parts.push_back(segment);
-        }
-        if (parts.size() == 3) {
-            if (parts[0] == "Admin") return new Admin(parts[1], parts[2]);
-            if (parts[0] == "Customer") return new Customer(parts[1], parts[2]);
-        }
+    User* userFromRecord(const DataRecord& rec) {
+        const string& role = rec.get("role");
+        if (role == "Admin") return new Admin(rec.get("username"), rec.get("password"));
+        if (role == "Customer") return new Customer(rec.get("username"), rec.get("password"));
         return nullptr;
     }
 
     void loadUsers() {
         ifstream userFile(USER_FILE);
-        string line;
-        while (getline(userFile, line)) {
-            if (!line.empty()) {
-                User* user = deserializeUser(line);
-                if (user) users.push_back(user);
-            }
+        RecordReader reader(userFile);
+        DataRecord rec;
+        while (reader.next(rec)) {
+            if (rec.tag() != "USER") continue; // Unknown record types are skipped
+            User* user = userFromRecord(rec);
+            if (user) users.push_back(user);
         }
         // Add initial dummy data if files are empty
         if (users.empty()) {
@@ -693,23 +3658,49 @@ private:
         }
     }
     
-    void saveData() const {
-        // Save Train data
+    void saveData() {
+        // Save Train data: station names and shared timetables first, then the trains
+        // that reference them by id
         ofstream trainFile(TRAIN_FILE);
         if (trainFile.is_open()) {
+            vector<vector<string>> trainRecords;
+            trainRecords.reserve(trains.size());
             for (const auto& train : trains) {
-                trainFile << train->serialize() << "\n";
+                trainRecords.push_back(train.recordFields()); // Interns any timetable not yet pooled
             }
+            RecordWriter out(trainFile, "trains");
+            DataFileMigrator::writeSchemas(out, "trains");
+            StationRegistry& stations = StationRegistry::getInstance();
+            for (uint32_t id = 0; id < stations.size(); ++id) out.write("STATION", {stations.name(id)});
+            const auto& timetables = TimetablePool::getInstance().all();
+            for (size_t id = 0; id < timetables.size(); ++id) {
+                out.write("TIMETABLE", {to_string(id), TimetablePool::encode(*timetables[id])});
+            }
+            for (const auto& fields : trainRecords) out.write("TRAIN", fields);
             trainFile.close();
         }
 
-        // Save Booking data
-        ofstream bookingFile(BOOKING_FILE);
+        // Save Booking data. After a lazy startup the records not yet faulted in are copied
+        // through from the current file, so the new one is written beside it and renamed over it.
+        bool copyThrough = lazyBookings.hasUnloaded();
+        string bookingPath = copyThrough ? BOOKING_FILE + ".saving" : BOOKING_FILE;
+        ofstream bookingFile(bookingPath, ios::trunc);
         if (bookingFile.is_open()) {
+            RecordWriter out(bookingFile, "bookings");
+            DataFileMigrator::writeSchemas(out, "bookings");
             for (const auto& booking : bookings) {
-                bookingFile << booking.serialize() << "\n";
+                out.write("BOOKING", booking.recordFields());
             }
+            bool copied = !copyThrough || lazyBookings.copyUnloaded(BOOKING_FILE, bookingFile);
             bookingFile.close();
+            if (copyThrough) {
+                if (copied && bookingFile && rename(bookingPath.c_str(), BOOKING_FILE.c_str()) == 0) {
+                    lazyBookings.commitRelocation();
+                } else {
+                    cerr << "[Error] Cannot rewrite " << BOOKING_FILE << ". Keeping the previous file." << endl;
+                    remove(bookingPath.c_str());
+                }
+            }
         }
         
         // Save Waitlist (Simplified: save waitlist map structure)
@@ -719,64 +3710,116 @@ private:
     }
 
     void loadData() {
-        // Load Train data (Simplified, only loads ExpressTrain)
+        // Per-phase startup profile: trains, seat maps, bookings, waitlist, users
+        LoadPhaseStats trainPhase{"trains"}, seatMapPhase{"seatmaps"}, bookingPhase{"bookings"},
+                       waitlistPhase{"waitlist"}, userPhase{"users"};
+
+        // Headerless (version-1) files are rewritten as version 2 before anything is read
+        DataFileMigrator::migrateAll();
+
+        // Load Train data (all TrainType records)
+        auto phaseStart = chrono::steady_clock::now();
         ifstream trainFile(TRAIN_FILE);
-        string line;
-        while (getline(trainFile, line)) {
-            if (line.empty()) continue;
-            
-            stringstream ss(line);
-            string type_str;
-            getline(ss, type_str, '|');
-
-            if (type_str == "EXPRESS") {
-                stringstream ts(line);
-                string segment;
-                vector<string> parts;
-                while (getline(ts, segment, '|')) {
-                    parts.push_back(segment);
+        RecordReader trainReader(trainFile);
+        DataRecord rec;
+        vector<shared_ptr<const Timetable>> fileTimetables; // TIMETABLE id -> pooled stop list
+        while (trainReader.next(rec)) {
+            // Station table first, then the timetables that index into it, then the trains
+            if (rec.tag() == "STATION") {
+                StationRegistry::getInstance().intern(rec.get("name"));
+            } else if (rec.tag() == "TIMETABLE") {
+                try {
+                    size_t id = stoul(rec.get("id"));
+                    if (fileTimetables.size() <= id) fileTimetables.resize(id + 1);
+                    fileTimetables[id] = TimetablePool::getInstance().intern(TimetablePool::decode(rec.get("stops")));
+                } catch (const std::exception& e) {
+                    cerr << "[Error] Timetable deserialization failed: " << e.what() << ". Skipping record." << endl;
                 }
-                
-                if (parts.size() >= 8) { // Check size
-                    try {
-                        Route r = Route::deserialize(parts[3]);
-                        Train* t = new ExpressTrain(
-                            parts[1], parts[2], r, stoi(parts[4]), stod(parts[5]), (parts[6] == "1")
-                        );
-                        
-                        size_t seatmap_start = line.find(parts[7]); 
-                        if (seatmap_start != string::npos) {
-                            string seatmap_data = line.substr(seatmap_start);
-                            dynamic_cast<ExpressTrain*>(t)->deserializeSeatMap(seatmap_data); 
-                        }
-                        trains.push_back(t);
-                    } catch (const std::exception& e) {
-                        cerr << "[Error] Train deserialization failed: " << e.what() << ". Skipping record: " << line.substr(0, 30) << "..." << endl;
-                    }
+            } else if (rec.tag() == "TRAIN") {
+                try {
+                    Train t = Train::fromRecord(rec, fileTimetables);
+                    auto seatMapStart = chrono::steady_clock::now();
+                    const string& seatmap_data = rec.get("seatmap");
+                    t.deserializeSeatMap(seatmap_data);
+                    seatMapPhase.elapsedMs += elapsedMsSince(seatMapStart);
+                    seatMapPhase.bytes += seatmap_data.size();
+                    seatMapPhase.records++;
+                    trains.push_back(move(t));
+                    trainPhase.records++;
+                } catch (const std::exception& e) {
+                    cerr << "[Error] Train deserialization failed: " << e.what() << ". Skipping record: "
+                         << rec.get("number") << endl;
                 }
-            }
+            } // Unknown record types are skipped
         }
+        // Seat map parsing is nested inside the train loop; report it separately
+        trainPhase.bytes = trainReader.getBytesRead();
+        trainPhase.elapsedMs = elapsedMsSince(phaseStart) - seatMapPhase.elapsedMs;
+        trainPhase.bytes -= min(trainPhase.bytes, seatMapPhase.bytes);
         
-        // Load Booking data
-        ifstream bookingFile(BOOKING_FILE);
-        while (getline(bookingFile, line)) {
-            if (!line.empty()) {
-                Booking loadedBooking = Booking::deserialize(line);
-                // If loaded booking is WL, re-add to the in-memory waitlist map
-                if (loadedBooking.getStatus() == "Waitlist") {
-                    placeOnWaitlist(loadedBooking);
-                }
-                bookings.push_back(loadedBooking);
+        // Load Booking data (lazy startup only indexes PNR -> train and offset; see ensureBookingsLoaded)
+        phaseStart = chrono::steady_clock::now();
+        bool lazy = false;
+        if (loadMode() != BookingLoadMode::Eager) {
+            lazy = lazyBookings.buildIndex(BOOKING_FILE, bookingPhase);
+            if (lazy) {
+                bookingPhase.name = "booking index";
+            } else {
+                cout << "[Startup] " << BOOKING_FILE << " uses another booking layout. Loading it eagerly." << endl;
+                bookingPhase.records = 0;
             }
         }
+        if (!lazy) {
+            ifstream bookingFile(BOOKING_FILE);
+            RecordReader bookingReader(bookingFile);
+            while (bookingReader.next(rec)) {
+                if (rec.tag() != "BOOKING") continue;
+                bookings.push_back(Booking::fromRecord(rec));
+                indexBooking(bookings.size() - 1);
+                bookingPhase.records++;
+            }
+            bookingPhase.bytes = bookingReader.getBytesRead();
+        }
+        pnrGenerator.resetIssued(bookings.size() + lazyBookings.unloadedCount());
+        for (const auto& loadedBooking : bookings) pnrGenerator.noteIssued(loadedBooking.getPNR());
+        lazyBookings.forEachUnloaded([this](const string& pnr, const LazyBookingStore::PnrRef&) {
+            pnrGenerator.noteIssued(pnr);
+        });
+        bookingPhase.elapsedMs = elapsedMsSince(phaseStart);
+
+        // Rebuild the in-memory waitlist map from WL bookings (file order preserves rank)
+        // and the live dashboard aggregates in the same pass
+        phaseStart = chrono::steady_clock::now();
+        for (const auto& loadedBooking : bookings) {
+            liveAggregates.onLoaded(findTrain(loadedBooking.getTrainNumber()), loadedBooking);
+            if (loadedBooking.getStatus() == "Waitlist") {
+                placeOnWaitlist(loadedBooking, false); // Silent rebuild, as on a lazy fault-in
+                waitlistPhase.bytes += sizeof(WaitlistEntry);
+                waitlistPhase.records++;
+            }
+        }
+        waitlistPhase.elapsedMs = elapsedMsSince(phaseStart);
         
+        phaseStart = chrono::steady_clock::now();
+        ifstream userSizeProbe(USER_FILE, ios::binary | ios::ate);
+        if (userSizeProbe.is_open()) userPhase.bytes = static_cast<size_t>(userSizeProbe.tellg());
         loadUsers(); // Load users
+        userPhase.records = users.size();
+        userPhase.elapsedMs = elapsedMsSince(phaseStart);
         
         // Add initial dummy data if files are empty
         if (trains.empty()) {
-            trains.push_back(new ExpressTrain("ET001", "Fast Express", Route("CityA", "CityB"), 10, 55.00, true)); // Reduced capacity for easy WL testing
-            trains.push_back(new ExpressTrain("SR205", "Slow Runner", Route("CityB", "CityC"), 50, 75.50, false));
+            trains.emplace_back(TrainType::Express, "ET001", "Fast Express", Route::fromStopList("CityA,N/A,08:00;MidPoint,12:00,12:15;CityB,18:00,N/A"),
+                                10, Money::fromPaise(5500), true); // Reduced capacity for easy WL testing
+            trains.emplace_back(TrainType::Express, "SR205", "Slow Runner", Route::fromStopList("CityB,N/A,08:00;MidPoint,12:00,12:15;CityC,18:00,N/A"),
+                                50, Money::fromPaise(7550), false);
         }
+
+        cout << "[Startup] " << trainPhase.summary() << " | " << seatMapPhase.summary() << " | "
+             << bookingPhase.summary() << " | " << waitlistPhase.summary() << " | "
+             << userPhase.summary() << endl;
+
+        if (lazy && loadMode() == BookingLoadMode::LazyPrefetch) lazyBookings.startPrefetch(BOOKING_FILE);
     }
 
 public:
@@ -784,6 +3827,11 @@ public:
     RailwayManager(const RailwayManager&) = delete;
     RailwayManager& operator=(const RailwayManager&) = delete;
 
+    // Startup mode for bookings; only takes effect if called before the first getInstance()
+    static void setBookingLoadMode(BookingLoadMode mode) {
+        loadMode() = mode;
+    }
+
     // Static method to get the single instance
     static RailwayManager& getInstance() {
         static RailwayManager instance;
@@ -799,89 +3847,545 @@ public:
                 }
             }
         }
-        return nullptr;
+        return nullptr;
+    }
+
+    // --- Core System Features ---
+
+    bool addTrain(const Train& train) {
+        InputCapture::getInstance().record({"ADD_TRAIN", trainTypeName(train.getType()), train.getTrainNumber(),
+                                            train.getTrainName(), train.getSource(), train.getDestination(),
+                                            train.classSeatsField(), train.classFareField(),
+                                            train.getPantryStatus() ? "1" : "0", to_string(train.getSpecialPremiumPct()),
+                                            train.getRoute().stopListText()});
+        if (findTrain(train.getTrainNumber())) {
+            cout << "\n❌ Error: Train number already exists." << endl;
+            return false;
+        }
+        trains.push_back(train);
+        cout << "\n✅ New " << trainTypeName(train.getType()) << " Train **" << train.getTrainNumber()
+             << "** added successfully." << endl;
+        saveData(); 
+        return true;
+    }
+    
+    bool removeTrain(const string& tNum) {
+        InputCapture::getInstance().record({"REMOVE_TRAIN", tNum});
+        auto it = remove_if(trains.begin(), trains.end(), 
+                            [&tNum](const Train& t){ return t.getTrainNumber() == tNum; });
+        if (it != trains.end()) {
+            trains.erase(it, trains.end());
+            saveData(); 
+            cout << "\n✅ Train **" << tNum << "** removed successfully." << endl;
+            return true;
+        }
+        cout << "\n❌ Error: Train **" << tNum << "** not found." << endl;
+        return false;
+    }
+
+    void viewAllTrains(const string& date = "") const {
+        ReportBuffer& out = ReportBuffer::console();
+        out << "\n## Available Trains" << (date.empty() ? "" : " for " + date) << " ##\n";
+        if (trains.empty()) {
+            out << "No trains currently available.\n";
+            out.flush();
+            return;
+        }
+        // Seat queries only read the seat map, so partitions can render trains in parallel
+        Date day = Date::parseOr(date);
+        renderRowsParallel(out, trains.size(), [this, &date, day](ReportBuffer& part, size_t i) {
+            const Train& train = trains[i];
+            train.displayDetails(part); 
+            if (!date.empty()) {
+                int available = train.getAvailableSeats(day);
+                
+                if (available < 0) {
+                     part << "    Does not run on " << date << ".\n";
+                } else {
+                     part << "    Available Seats on " << date << ": **" << available << "**";
+                     if (!train.offersOnlySleeper()) {
+                         const char* sep = " (";
+                         for (int c = 0; c < CLASS_COUNT; ++c) {
+                             if (!train.offersClass(c)) continue;
+                             part << sep << coachClassName(c) << ' ' << train.getAvailableSeats(day, c);
+                             sep = " | ";
+                         }
+                         part << ')';
+                     }
+                     part << '\n';
+                }
+            }
+            part << "----------------------\n";
+        }, 64, 1024);
+        out.flush();
+    }
+    
+    // FIX: Implementation for View All Bookings (Admin Report)
+    void viewAllBookings() {
+        ensureAllBookingsLoaded();
+        ReportBuffer& out = ReportBuffer::console();
+        out << "\n==============================================\n";
+        out << "📊 **ADMIN REPORT: ALL BOOKINGS**\n";
+        out << "==============================================\n";
+
+        if (bookings.empty()) {
+            out << "No bookings found in the system.\n";
+            out.flush();
+            return;
+        }
+
+        out.field("PNR", 15).field("Train", 10).field("Date", 15)
+           .field("Seats", 10).field("Fare (₹)", 15).field("Status", 15) << '\n';
+        out << string(74, '-') << '\n';
+
+        renderRowsParallel(out, bookings.size(), [this](ReportBuffer& part, size_t i) {
+            const Booking& booking = bookings[i];
+            part.field(booking.getPNR(), 15)
+                .field(booking.getTrainNumber(), 10)
+                .field(booking.getDate(), 15)
+                .field(booking.getNumPassengers(), 10)
+                .fixed2Field(booking.getTotalFare(), 15)
+                .field(booking.getStatus(), 15) << '\n';
+        });
+        out << string(74, '-') << '\n';
+        out.flush();
+    }
+
+    // Streams bookings, per-train-date inventory or waitlists as CSV or NDJSON to 'sink'.
+    // Rows go through a fixed 64 KB chunk buffer, so memory stays constant with size.
+    // Returns the number of rows written, or -1 for an unknown dataset/format.
+    long long exportData(const string& dataset, const string& format, ostream& sink) {
+        bool csv = (format == "csv");
+        if (!csv && format != "ndjson") return -1;
+        ensureAllBookingsLoaded();
+
+        ReportBuffer out(64 * 1024, sink);
+        long long rows = 0;
+
+        if (dataset == "bookings") {
+            if (csv) out << "pnr,train,date,class,seats,fare,status\n";
+            for (const auto& b : bookings) {
+                if (csv) {
+                    csvField(out, b.getPNR()) << ',';
+                    csvField(out, b.getTrainNumber()) << ',';
+                    csvField(out, b.getDate()) << ',' << coachClassName(b.getCoachClass()) << ','
+                        << b.getNumPassengers() << ',';
+                    out.fixed2(b.getTotalFare()) << ',';
+                    csvField(out, b.getStatus()) << '\n';
+                } else {
+                    out << "{\"pnr\":"; jsonString(out, b.getPNR());
+                    out << ",\"train\":"; jsonString(out, b.getTrainNumber());
+                    out << ",\"date\":"; jsonString(out, b.getDate());
+                    out << ",\"class\":\"" << coachClassName(b.getCoachClass()) << '"';
+                    out << ",\"seats\":" << b.getNumPassengers() << ",\"fare\":";
+                    out.fixed2(b.getTotalFare()) << ",\"status\":";
+                    jsonString(out, b.getStatus()) << "}\n";
+                }
+                rows++;
+            }
+        } else if (dataset == "inventory") {
+            if (csv) out << "train,date,class,total_seats,available_seats,sold_seats\n";
+            for (const auto& train : trains) {
+                for (const auto& alloc : train.getSeatMap()) {
+                    for (int c = 0; c < CLASS_COUNT; ++c) {
+                        if (!train.offersClass(c)) continue;
+                        int sold = train.getClassSeats(c) - alloc.available[c];
+                        if (csv) {
+                            csvField(out, train.getTrainNumber()) << ',';
+                            csvField(out, alloc.date.toString()) << ',' << coachClassName(c) << ',' << train.getClassSeats(c) << ','
+                                << alloc.available[c] << ',' << sold << '\n';
+                        } else {
+                            out << "{\"train\":"; jsonString(out, train.getTrainNumber());
+                            out << ",\"date\":"; jsonString(out, alloc.date.toString());
+                            out << ",\"class\":\"" << coachClassName(c) << '"';
+                            out << ",\"total_seats\":" << train.getClassSeats(c)
+                                << ",\"available_seats\":" << alloc.available[c]
+                                << ",\"sold_seats\":" << sold << "}\n";
+                        }
+                        rows++;
+                    }
+                }
+            }
+        } else if (dataset == "waitlist") {
+            if (csv) out << "train,date,class,rank,pnr,seats\n";
+            for (const auto& queue : waitlist) {
+                string tNum = queue.first.substr(0, queue.first.find('|'));
+                for (const auto& entry : queue.second) {
+                    if (csv) {
+                        csvField(out, tNum) << ',';
+                        csvField(out, entry.date) << ',' << coachClassName(entry.coachClass) << ',' << entry.rank << ',';
+                        csvField(out, entry.pnr) << ',' << entry.numSeats << '\n';
+                    } else {
+                        out << "{\"train\":"; jsonString(out, tNum);
+                        out << ",\"date\":"; jsonString(out, entry.date);
+                        out << ",\"class\":\"" << coachClassName(entry.coachClass) << '"';
+                        out << ",\"rank\":" << entry.rank << ",\"pnr\":";
+                        jsonString(out, entry.pnr) << ",\"seats\":" << entry.numSeats << "}\n";
+                    }
+                    rows++;
+                }
+            }
+        } else {
+            return -1;
+        }
+
+        out.flush();
+        return rows;
+    }
+
+    // Copies trains, seat maps and bookings into the columnar aggregation engine
+    RevenueAggregator buildAggregator() {
+        ensureAllBookingsLoaded();
+        RevenueAggregator agg;
+        size_t inventoryRows = 0;
+        for (const auto& train : trains) inventoryRows += train.getSeatMapSize();
+        agg.reserve(bookings.size(), inventoryRows);
+        for (const auto& train : trains) {
+            agg.addTrain(train.getTrainNumber(), train.getSource(), train.getDestination());
+            for (const auto& alloc : train.getSeatMap()) {
+                agg.addInventory(train.getTrainNumber(), alloc.date, train.getTotalSeats());
+            }
+        }
+        for (const auto& b : bookings) {
+            agg.addBooking(b.getTrainNumber(), b.getDate(), b.getStatus(), b.getNumPassengers(), b.getTotalFare());
+        }
+        return agg;
+    }
+
+    // Admin Report: revenue, seats sold and load factor grouped by train, date or route
+    void viewRevenueReport(RevenueAggregator::GroupBy groupBy, const string& fromDate, const string& toDate) {
+        RevenueAggregator agg = buildAggregator();
+        auto start = chrono::steady_clock::now();
+        vector<AggregateRow> rows = agg.aggregate(groupBy, dateSortKey(fromDate), dateSortKey(toDate));
+        double scanMs = elapsedMsSince(start);
+
+        ReportBuffer& out = ReportBuffer::console();
+        out << "\n==============================================\n";
+        out << "💰 **ADMIN REPORT: REVENUE & OCCUPANCY (" << fromDate << " - " << toDate << ")**\n";
+        out << "==============================================\n";
+        out.field(groupBy == RevenueAggregator::GroupBy::Train ? "Train"
+                  : groupBy == RevenueAggregator::GroupBy::Date ? "Date" : "Route", 22)
+           .field("Bookings", 10).field("Seats", 10).field("Revenue (₹)", 16).field("Capacity", 10)
+           .field("Load %", 8) << '\n';
+        out << string(76, '-') << '\n';
+        Money totalRevenue;
+        for (const auto& row : rows) {
+            out.field(row.group, 22).field(row.bookings, 10).field(row.seats, 10)
+               .fixed2Field(row.revenue, 16).field(row.capacity, 10).fixed2Field(row.loadFactor * 100.0, 8) << '\n';
+            totalRevenue += row.revenue;
+        }
+        out << string(76, '-') << '\n';
+        out << "Total Revenue: ₹";
+        out.fixed2(totalRevenue) << " (" << agg.bookingRows() << " rows scanned in ";
+        out.fixed2(scanMs) << " ms)\n";
+        out.flush();
+    }
+
+    // Builds the passenger manifest for one train and date from the (train, date) index,
+    // writes it sorted by seat to chart_<Train>_<MMDDYYYY>.txt and freezes the inventory.
+    // Returns the number of passengers charted, -1 if the chart already exists, or -2 if the
+    // chart file cannot be written (the inventory is then left open).
+    int prepareChart(Train* train, const string& date) {
+        Date day = Date::parseOr(date);
+        if (train->isChartPrepared(day)) return -1;
+        ensureBookingsLoaded(train->getTrainNumber());
+
+        vector<size_t> confirmed;
+        auto idx = bookingIndex.find(train->getTrainNumber() + "|" + date);
+        if (idx != bookingIndex.end()) {
+            for (size_t pos : idx->second) {
+                if (bookings[pos].getStatus() == "Confirmed") confirmed.push_back(pos);
+            }
+        }
+        // Grouped by class, seats allotted in PNR (booking) order; PNRs share a width so string order works.
+        // Seat labels are assigned here, at chart time, so they are only stable once the chart is out.
+        sort(confirmed.begin(), confirmed.end(), [this](size_t a, size_t b) {
+            if (bookings[a].getCoachClass() != bookings[b].getCoachClass()) {
+                return bookings[a].getCoachClass() < bookings[b].getCoachClass();
+            }
+            return bookings[a].getPNR() < bookings[b].getPNR();
+        });
+
+        string fileDate = date;
+        fileDate.erase(remove(fileDate.begin(), fileDate.end(), '/'), fileDate.end());
+        string chartPath = "chart_" + train->getTrainNumber() + "_" + fileDate + ".txt";
+        ofstream chartFile(chartPath, ios::trunc);
+        if (!chartFile.is_open()) { // Inventory stays open: no chart, no freeze
+            cerr << "[Error] Cannot write " << chartPath << ". Chart not prepared." << endl;
+            return -2;
+        }
+        ReportBuffer out(64 * 1024, chartFile);
+        out << "RESERVATION CHART | " << train->getTrainNumber() << " " << train->getTrainName()
+            << " | " << date << " | " << train->getSource() << " -> " << train->getDestination() << '\n';
+        out.field("Seat", 8).field("PNR", 15).field("Name", 24).field("Age", 5).field("Gender", 8)
+           .field("Boarding", 12) << '\n';
+
+        int seat = 0;
+        int classSeat[CLASS_COUNT] = {};
+        for (size_t pos : confirmed) {
+            int cls = bookings[pos].getCoachClass();
+            for (const auto& p : bookings[pos].getPassengers()) {
+                const string& boarding = bookings[pos].getBoardingStation();
+                seat++;
+                out.field(string(coachClassName(cls)) + "-" + to_string(++classSeat[cls]), 8).field(bookings[pos].getPNR(), 15).field(p.getName(), 24)
+                   .field(p.getAge(), 5).field(p.getGender(), 8).field(boarding.empty() ? train->getSource() : boarding, 12) << '\n';
+            }
+        }
+        out << "Total Passengers: " << seat << '\n';
+        out.flush();
+
+        train->freezeInventory(day);
+        return seat;
+    }
+
+    // Chart preparation for every train running on 'date'
+    void prepareCharts(const string& date) {
+        InputCapture::getInstance().record({"CHART", date});
+        auto start = chrono::steady_clock::now();
+        int charted = 0;
+        Date day = Date::parseOr(date);
+        for (auto& train : trains) {
+            if (!train.runsOn(day)) continue;
+            int passengers = prepareChart(&train, date);
+            if (passengers == -1) {
+                cout << "    " << train.getTrainNumber() << ": chart already prepared." << endl;
+            } else if (passengers < 0) {
+                cout << "    ❌ " << train.getTrainNumber() << ": chart file could not be written." << endl;
+            } else {
+                cout << "    ✅ " << train.getTrainNumber() << ": " << passengers << " passenger(s) charted." << endl;
+                charted++;
+            }
+        }
+        cout << "\n" << charted << " chart(s) prepared for " << date << " in " << fixed << setprecision(2)
+             << elapsedMsSince(start) << " ms." << endl;
+        if (charted > 0) saveData(); // Persist the frozen inventory
+    }
+
+    // Transaction time-series: rolls up new log records, then prints bucketed counters.
+    // 'filter' is "all", "train:<Num>" or "route:<Src>-><Dest>".
+    void viewTransactionSeries(const string& filter, int bucketMinutes) const {
+        unordered_map<string, string> pnrTrain;
+        for (const auto& b : bookings) pnrTrain[b.getPNR()] = b.getTrainNumber();
+        lazyBookings.forEachUnloaded([&pnrTrain](const string& pnr, const LazyBookingStore::PnrRef& ref) {
+            pnrTrain[pnr] = ref.trainNumber;
+        });
+
+        TxRollup rollup(TX_ROLLUP_FILE);
+        size_t added = rollup.update(TX_LOG_FILE, pnrTrain);
+
+        unordered_map<string, string> trainRoute;
+        for (const auto& train : trains) {
+            trainRoute[train.getTrainNumber()] = train.getSource() + "->" + train.getDestination();
+        }
+        auto match = [&filter, &trainRoute](const string& tNum) {
+            if (filter == "all") return true;
+            if (filter.compare(0, 6, "train:") == 0) return tNum == filter.substr(6);
+            if (filter.compare(0, 6, "route:") == 0) {
+                auto it = trainRoute.find(tNum);
+                return it != trainRoute.end() && it->second == filter.substr(6);
+            }
+            return false;
+        };
+        map<long long, TxCounters> series = rollup.series(match, bucketMinutes);
+
+        ReportBuffer& out = ReportBuffer::console();
+        out << "\n==============================================\n";
+        out << "📈 **TRANSACTION TIME-SERIES (" << filter << ", " << bucketMinutes << " min buckets)**\n";
+        out << "==============================================\n";
+        out << "(" << added << " new log record(s) rolled up)\n";
+        out.field("Bucket Start", 20).field("Bookings", 10).field("Cancelled", 11).field("Pay Failed", 11) << '\n';
+        out << string(52, '-') << '\n';
+        for (const auto& row : series) {
+            out.field(TxRollup::formatMinute(row.first), 20).field(row.second.bookings, 10)
+               .field(row.second.cancellations, 11).field(row.second.paymentFailures, 11) << '\n';
+        }
+        if (series.empty()) out << "No transactions match.\n";
+        out.flush();
+    }
+
+    bool addPricingRule(const string& tNum, const PricingRule& rule) {
+        Train* train = findTrain(tNum);
+        if (!train) {
+            cout << "\n❌ Error: Train **" << tNum << "** not found." << endl;
+            return false;
+        }
+        InputCapture::getInstance().record({"ADD_RULE", tNum, rule.name,
+                                            to_string(rule.fromKey), to_string(rule.toKey), to_string(rule.occLow),
+                                            to_string(rule.occHigh), to_string(rule.daysLow), to_string(rule.daysHigh),
+                                            to_string(rule.multiplier)});
+        train->addPricingRule(rule);
+        saveData();
+        cout << "\n✅ Pricing rule **" << rule.name << "** added to " << tNum << " ("
+             << train->getPricing().getRules().size() << " rule(s))." << endl;
+        return true;
+    }
+
+    bool setFareLadder(const string& tNum, int stepPercent, double stepMarkup) {
+        Train* train = findTrain(tNum);
+        if (!train) {
+            cout << "\n❌ Error: Train **" << tNum << "** not found." << endl;
+            return false;
+        }
+        InputCapture::getInstance().record({"SET_LADDER", tNum, to_string(stepPercent), to_string(stepMarkup)});
+        train->setFareLadder(stepPercent, stepMarkup);
+        saveData();
+        cout << "\n✅ Fare ladder for " << tNum << ": +" << fixed << setprecision(1) << stepMarkup * 100.0
+             << "% per " << stepPercent << "% sold." << endl;
+        return true;
     }
 
-    // --- Core System Features ---
+    const ServiceCalendar* serviceCalendarOf(const string& tNum) {
+        Train* train = findTrain(tNum);
+        return train ? &train->getCalendar() : nullptr;
+    }
 
-    void addTrain(Train* train) {
-        if (findTrain(train->getTrainNumber())) {
-            cout << "\n❌ Error: Train number already exists." << endl;
-            delete train; 
-            return;
+    bool setServiceCalendar(const string& tNum, const ServiceCalendar& calendar) {
+        Train* train = findTrain(tNum);
+        if (!train) {
+            cout << "\n❌ Error: Train **" << tNum << "** not found." << endl;
+            return false;
         }
-        trains.push_back(train);
-        cout << "\n✅ New Train **" << train->getTrainNumber() << "** added successfully." << endl;
-        saveData(); 
+        InputCapture::getInstance().record({"SET_CALENDAR", tNum, calendar.serialize()});
+        size_t blocksBefore = train->getSeatMapSize();
+        train->setCalendar(calendar);
+        ensureBookingsLoaded(tNum);
+        size_t stranded = cancelStrandedBookings(train);
+        if (stranded > 0) train->pruneIdleDays(); // Their seats are back, so those days are idle now
+        quoteCache.clear(); // Quotes for dropped days must not outlive their inventory
+        saveData();
+        cout << "\n✅ Service calendar for " << tNum << " updated: " << calendar.weekdaysText() << " ("
+             << blocksBefore - train->getSeatMapSize() << " idle inventory day(s) released, "
+             << stranded << " booking(s) on non-running days cancelled)." << endl;
+        return true;
     }
-    
-    bool removeTrain(const string& tNum) {
-        auto it = remove_if(trains.begin(), trains.end(), 
-                            [&tNum](Train* t){ return t->getTrainNumber() == tNum; });
-        if (it != trains.end()) {
-            delete *it; 
-            trains.erase(it, trains.end());
-            saveData(); 
-            cout << "\n✅ Train **" << tNum << "** removed successfully." << endl;
-            return true;
+
+    // Confirmed and waitlisted bookings on days 'train' no longer runs are cancelled by the
+    // railway: full refund, seats released, and that day's waitlist dropped
+    size_t cancelStrandedBookings(Train* train) {
+        const string& tNum = train->getTrainNumber();
+        size_t cancelled = 0;
+        for (const auto& entry : bookingIndex) {
+            const string& key = entry.first;
+            if (key.compare(0, tNum.size() + 1, tNum + "|") != 0) continue;
+            Date day = Date::parseOr(string_view(key).substr(tNum.size() + 1));
+            if (!day.valid() || train->runsOn(day)) continue;
+            for (size_t pos : entry.second) {
+                Booking& booking = bookings[pos];
+                string previousStatus = booking.getStatus();
+                if (previousStatus != "Confirmed" && previousStatus != "Waitlist") continue;
+                if (previousStatus == "Confirmed") {
+                    train->cancelSeat(day, booking.getNumPassengers(), booking.getCoachClass());
+                }
+                booking.setStatus("Cancelled");
+                liveAggregates.onCancelled(train, booking, previousStatus);
+                paymentGateway.logTransaction(booking.getPNR(), "SERVICE_CANCELLED", "FULL_REFUND", tNum);
+                cout << "\n⚠️ PNR **" << booking.getPNR() << "** (" << booking.getDate() << ", " << previousStatus
+                     << ") cancelled: " << tNum << " no longer runs that day." << endl;
+                paymentGateway.processRefund(booking.getTotalFare());
+                cancelled++;
+            }
+            waitlist.erase(key);
         }
-        cout << "\n❌ Error: Train **" << tNum << "** not found." << endl;
-        return false;
+        return cancelled;
     }
 
-    void viewAllTrains(const string& date = "") const {
-        cout << "\n## Available Trains" << (date.empty() ? "" : " for " + date) << " ##" << endl;
-        if (trains.empty()) {
-            cout << "No trains currently available." << endl;
-            return;
+    // Live Dashboard: reads the incremental aggregates, no booking scan
+    void viewLiveDashboard() {
+        ensureAllBookingsLoaded(); // Aggregates only cover resident bookings
+        ReportBuffer& out = ReportBuffer::console();
+        out << "\n==============================================\n";
+        out << "📡 **LIVE DASHBOARD: OCCUPANCY & REVENUE**\n";
+        out << "==============================================\n";
+        out.field("Route", 24).field("Sold", 8).field("Revenue (₹)", 16).field("Cancelled", 11)
+           .field("WL", 6) << '\n';
+        out << string(66, '-') << '\n';
+        for (const auto& route : liveAggregates.routes()) {
+            const LiveAggregate& a = route.second;
+            out.field(route.first, 24).field(a.seatsSold, 8).fixed2Field(a.revenue, 16)
+               .field(a.cancellations, 11).field(a.waitlistDepth, 6) << '\n';
         }
-        for (const auto& train : trains) {
-            train->displayDetails(); 
-            if (!date.empty()) {
-                Train* nonConstTrain = const_cast<RailwayManager*>(this)->findTrain(train->getTrainNumber());
-                int available = nonConstTrain ? nonConstTrain->getAvailableSeats(date) : -1;
-                
-                if (available >= 0) {
-                     cout << "    Available Seats on " << date << ": **" << available << "**" << endl;
-                }
-            }
-            cout << "----------------------" << endl;
+        out << '\n';
+        out.field("Train|Date", 24).field("Sold", 8).field("Revenue (₹)", 16).field("Cancelled", 11)
+           .field("WL", 6).field("Load %", 8) << '\n';
+        out << string(74, '-') << '\n';
+        for (const auto& td : liveAggregates.trainDates()) {
+            const LiveAggregate& a = td.second;
+            const Train* train = findTrain(td.first.substr(0, td.first.find('|')));
+            double load = (train && train->getTotalSeats() > 0) ? 100.0 * a.seatsSold / train->getTotalSeats() : 0.0;
+            out.field(td.first, 24).field(a.seatsSold, 8).fixed2Field(a.revenue, 16)
+               .field(a.cancellations, 11).field(a.waitlistDepth, 6).fixed2Field(load, 8) << '\n';
         }
+        out.flush();
     }
-    
-    // FIX: Implementation for View All Bookings (Admin Report)
-    void viewAllBookings() const {
+
+    LiveAggregate getLiveAggregate(const string& tNum, const string& date) {
+        ensureBookingsLoaded(tNum);
+        return liveAggregates.forTrainDate(tNum, date);
+    }
+
+    // FNV-1a digest over the persisted train, booking and PNR counter state (used by capture/replay)
+    string stateDigest() {
+        ensureAllBookingsLoaded();
+        unsigned long long hash = 14695981039346656037ULL;
+        auto mix = [&hash](const string& data) {
+            for (unsigned char c : data) {
+                hash ^= c;
+                hash *= 1099511628211ULL;
+            }
+            hash ^= '\n';
+            hash *= 1099511628211ULL;
+        };
+        for (const auto& train : trains) mix(train.serialize());
+        for (const auto& booking : bookings) mix(booking.serialize());
+        mix(to_string(pnrGenerator.lastIssued())); // Replayed PNRs continue from the counter
+        stringstream ss;
+        ss << hex << setw(16) << setfill('0') << hash;
+        return ss.str();
+    }
+
+    // Admin Stats: live heap bytes per subsystem, plus per-booking and per-train-date ratios
+    void viewSystemStats() const {
         cout << "\n==============================================" << endl;
-        cout << "📊 **ADMIN REPORT: ALL BOOKINGS**" << endl;
+        cout << "📈 **ADMIN STATS: MEMORY BY SUBSYSTEM**" << endl;
         cout << "==============================================" << endl;
 
-        if (bookings.empty()) {
-            cout << "No bookings found in the system." << endl;
-            return;
+        cout << left << setw(15) << "Subsystem" << setw(15) << "Live Bytes" << setw(10) << "Blocks" << endl;
+        cout << string(40, '-') << endl;
+        long long totalBytes = 0;
+        for (int i = 0; i < static_cast<int>(MemTag::Count); ++i) {
+            long long bytes = memCounters[i].liveBytes;
+            totalBytes += bytes;
+            cout << left << setw(15) << memTagName(static_cast<MemTag>(i))
+                 << setw(15) << bytes << setw(10) << memCounters[i].liveBlocks << endl;
         }
+        cout << string(40, '-') << endl;
+        cout << left << setw(15) << "Total" << totalBytes << endl;
 
-        cout << left << setw(15) << "PNR" 
-             << setw(10) << "Train"
-             << setw(15) << "Date"
-             << setw(10) << "Seats"
-             << setw(15) << "Fare (₹)"
-             << setw(15) << "Status" << endl;
-        cout << string(74, '-') << endl;
-
-        for (const auto& booking : bookings) {
-            cout << left << setw(15) << booking.getPNR() 
-                 << setw(10) << booking.getTrainNumber()
-                 << setw(15) << booking.getDate()
-                 << setw(10) << booking.getNumPassengers()
-                 << setw(15) << fixed << setprecision(2) << booking.getTotalFare()
-                 << setw(15) << booking.getStatus() << endl;
+        size_t trainDates = 0;
+        for (const auto& train : trains) {
+            trainDates += train.getSeatMapSize();
         }
-        cout << string(74, '-') << endl;
+        long long bookingBytes = memCounters[static_cast<int>(MemTag::Bookings)].liveBytes
+                               + memCounters[static_cast<int>(MemTag::Passengers)].liveBytes;
+        long long seatMapBytes = memCounters[static_cast<int>(MemTag::SeatMaps)].liveBytes;
+
+        cout << fixed << setprecision(1);
+        cout << "Bookings: " << bookings.size() << ", Bytes/Booking (incl. passengers): "
+             << (bookings.empty() ? 0.0 : static_cast<double>(bookingBytes) / bookings.size()) << endl;
+        cout << "Train-Dates: " << trainDates << ", Bytes/Train-Date: "
+             << (trainDates == 0 ? 0.0 : static_cast<double>(seatMapBytes) / trainDates) << endl;
+        unsigned long long lookups = quoteCache.getHits() + quoteCache.getMisses();
+        cout << "Fare Quote Cache: " << quoteCache.size() << " entries, " << quoteCache.getHits() << "/" << lookups
+             << " hits (" << (lookups ? 100.0 * quoteCache.getHits() / lookups : 0.0) << "%)" << endl;
+        const PnrBloomFilter& pnrFilter = pnrGenerator.getIssuedFilter();
+        cout << "PNR Filter: " << pnrFilter.keyCount() << " PNRs in " << pnrFilter.layerCount() << " layer(s), "
+             << pnrFilter.byteSize() << " bytes, " << pnrFilter.getRejected() << "/" << pnrFilter.getLookups()
+             << " lookups rejected without a scan" << endl;
+        if (loadMode() != BookingLoadMode::Eager) cout << "Lazy Bookings: " << lazyBookings.describe() << endl;
     }
 
     // NEW FEATURE: View Transaction History for a PNR
     void viewTransactionHistory(const string& pnr) const {
-        ifstream logFile(TX_LOG_FILE);
         string line;
         bool found = false;
 
@@ -889,14 +4393,18 @@ public:
         cout << "📜 **TRANSACTION HISTORY FOR PNR: " << pnr << "**" << endl;
         cout << "==============================================" << endl;
 
-        while (getline(logFile, line)) {
-            // Find the PNR in the line (simplified search for the demo)
-            if (line.find(pnr) != string::npos) {
-                cout << line;
-                found = true;
+        // Never-issued PNRs skip the full log scan. Payment-failed attempts are persisted as
+        // Failed bookings, so their PNRs still find their log records after a restart.
+        if (pnrGenerator.mayExist(pnr)) {
+            ifstream logFile(TX_LOG_FILE);
+            while (getline(logFile, line)) {
+                // Find the PNR in the line (simplified search for the demo)
+                if (line.find(pnr) != string::npos) {
+                    cout << line;
+                    found = true;
+                }
             }
         }
-        logFile.close();
 
         if (!found) {
             cout << "No transaction records found for this PNR." << endl;
@@ -905,15 +4413,34 @@ public:
         }
     }
     
-    void searchTrain(const string& src, const string& dest, const string& date) {
-        cout << "\n## Search Results (" << src << " to " << dest << " on " << date << ") ##" << endl;
+    // 'cls' limits results to trains offering that CoachClass; -1 lists every class
+    void searchTrain(const string& src, const string& dest, const string& date, int cls = -1) {
+        cout << "\n## Search Results (" << src << " to " << dest << " on " << date
+             << (cls >= 0 ? string(", class ") + coachClassName(cls) : string()) << ") ##" << endl;
         bool found = false;
+        Date day = Date::parseOr(date);
         for (auto& train : trains) {
-            if (train->getSource() == src && train->getDestination() == dest) {
-                train->displayDetails();
-                int available = train->getAvailableSeats(date);
-                if (available >= 0) {
+            if (train.getRoute().servesSegment(src, dest) && (cls < 0 || train.offersClass(cls))) {
+                train.displayDetails();
+                int available = train.getAvailableSeats(day);
+                if (available < 0) {
+                    cout << "    ⚠️ Does not run on " << date << "." << endl;
+                } else {
                     cout << "    Available Seats on " << date << ": **" << available << "**" << endl;
+                    if (train.getType() != TrainType::Passenger && train.getPricing().getLadderStepPercent() > 0) {
+                        cout << "    Surge step: " << train.fareStep(day) << endl;
+                    }
+                    // Representative single-passenger quotes, served from the quote cache
+                    static const vector<Passenger> adult{Passenger("", 30, "M")}, child{Passenger("", 8, "M")},
+                                                   seniorM{Passenger("", 60, "M")}, seniorF{Passenger("", 58, "F")};
+                    for (int c = 0; c < CLASS_COUNT; ++c) {
+                        if (!train.offersClass(c) || (cls >= 0 && c != cls)) continue;
+                        cout << "    " << coachClassName(c) << ": **" << train.getAvailableSeats(day, c)
+                             << "** left | Fare ₹" << cachedGroupQuote(&train, day, adult, c) << " per passenger" << endl;
+                        cout << "        Concessions: Child ₹" << cachedGroupQuote(&train, day, child, c) << " | Senior M ₹"
+                             << cachedGroupQuote(&train, day, seniorM, c) << " | Senior F ₹"
+                             << cachedGroupQuote(&train, day, seniorF, c) << endl;
+                    }
                 }
                 cout << "----------------------" << endl;
                 found = true;
@@ -925,7 +4452,16 @@ public:
     }
 
     // NEW FUNCTION: Handles the logic for a single train booking
-    void bookSingleTicket(const string& tNum, const string& date, const vector<Passenger>& passengers) {
+    // 'boarding' is the station the group boards at; empty means the train's origin
+    void bookSingleTicket(const string& tNum, const string& date, const vector<Passenger>& passengers,
+                          int cls = CLASS_SL, const string& boarding = "") {
+        if (InputCapture::getInstance().isCapturing()) {
+            string p_data;
+            for (const auto& p : passengers) {
+                p_data += (p_data.empty() ? "" : "&") + p.serialize();
+            }
+            InputCapture::getInstance().record({"BOOK", tNum, date, p_data, coachClassName(cls), boarding});
+        }
         Train* selectedTrain = findTrain(tNum);
         int numPassengers = passengers.size();
 
@@ -934,44 +4470,111 @@ public:
             return;
         }
 
-        double fare = selectedTrain->getBaseFare() * numPassengers;
+        Date day = Date::parseOr(date);
+        if (selectedTrain->isChartPrepared(day)) {
+            cout << "    ❌ Booking Failed (Chart already prepared for " << tNum << " on " << date << ")." << endl;
+            return;
+        }
+
+        if (!selectedTrain->offersClass(cls)) {
+            cout << "    ❌ Booking Failed (" << tNum << " has no " << coachClassName(cls) << " class)." << endl;
+            return;
+        }
+
+        if (!boarding.empty() && !selectedTrain->getRoute().servesSegment(boarding, selectedTrain->getDestination())) {
+            cout << "    ❌ Booking Failed (" << tNum << " does not call at " << boarding << " before "
+                 << selectedTrain->getDestination() << ")." << endl;
+            return;
+        }
+
+        if (selectedTrain->getAvailableSeats(day, cls) < 0) { // No inventory: not a running day
+            cout << "    ❌ Booking Failed (" << tNum << " does not run on " << date << ")." << endl;
+            return;
+        }
+
+        ensureBookingsLoaded(tNum); // Waitlist ranks continue from the train's existing entries
+        Money fare = cachedGroupQuote(selectedTrain, day, passengers, cls);
         string pnr = pnrGenerator.generate(); 
         string finalStatus = "Waitlist"; 
 
-        paymentGateway.logTransaction(pnr, "BOOKING_ATTEMPT", "PENDING_PAYMENT");
+        paymentGateway.logTransaction(pnr, "BOOKING_ATTEMPT", "PENDING_PAYMENT", tNum);
         
-        if (selectedTrain->getAvailableSeats(date) >= numPassengers) {
+        if (selectedTrain->getAvailableSeats(day, cls) >= numPassengers) {
             if (paymentGateway.processPayment(fare)) {
-                selectedTrain->bookSeat(date, numPassengers);
+                selectedTrain->bookSeat(day, numPassengers, cls);
                 finalStatus = "Confirmed";
-                paymentGateway.logTransaction(pnr, "PAYMENT_SUCCESS", "COMMITTED");
+                paymentGateway.logTransaction(pnr, "PAYMENT_SUCCESS", "COMMITTED", tNum);
             } else {
-                paymentGateway.logTransaction(pnr, "PAYMENT_FAILED", "ROLLED_BACK");
-                cout << "    ❌ Transaction failed: Payment declined (Train " << tNum << "). Ticket NOT issued." << endl;
-                return;
+                paymentGateway.logTransaction(pnr, "PAYMENT_FAILED", "ROLLED_BACK", tNum);
+                finalStatus = "Failed";
             }
         } else {
              if (paymentGateway.processPayment(fare)) {
-                paymentGateway.logTransaction(pnr, "PAYMENT_SUCCESS", "WAITLISTED");
+                paymentGateway.logTransaction(pnr, "PAYMENT_SUCCESS", "WAITLISTED", tNum);
              } else {
-                paymentGateway.logTransaction(pnr, "PAYMENT_FAILED", "ROLLED_BACK");
-                cout << "    ❌ Transaction failed: Payment declined (Train " << tNum << "). Ticket NOT issued." << endl;
-                return;
+                paymentGateway.logTransaction(pnr, "PAYMENT_FAILED", "ROLLED_BACK", tNum);
+                finalStatus = "Failed";
              }
         }
         
         // Finalize Booking
-        Booking newBooking(pnr, tNum, date, passengers, fare, finalStatus); 
+        Booking newBooking(pnr, tNum, date, passengers, fare, finalStatus, cls, boarding); 
         bookings.push_back(newBooking);
+        indexBooking(bookings.size() - 1);
+
+        // A failed attempt is kept as a Failed booking (no seats, no waitlist place, no revenue)
+        // so its PNR is reloaded into the issued-PNR filter and its log records stay reachable
+        if (finalStatus == "Failed") {
+            cout << "    ❌ Transaction failed: Payment declined (Train " << tNum << "). Ticket NOT issued." << endl;
+            saveData();
+            return;
+        }
 
         if (finalStatus == "Waitlist") {
             placeOnWaitlist(newBooking);
+            liveAggregates.onWaitlisted(selectedTrain, newBooking);
+        } else {
+            liveAggregates.onConfirmed(selectedTrain, newBooking);
         }
         
-        cout << "\n    ✅ GROUP BOOKED! PNR: **" << pnr << "** | Status: " << finalStatus << endl;
+        cout << "\n    ✅ GROUP BOOKED! PNR: **" << pnr << "** | Class: " << coachClassName(cls)
+             << " | Status: " << finalStatus << endl;
         saveData();
     }
     
+    // Group quote through the cache; computes (and stores) only on a miss
+    template <typename PassengerRange>
+    Money cachedGroupQuote(Train* train, Date day, const PassengerRange& passengers, int cls = CLASS_SL) {
+        FareQuoteKey key{train->getTrainNumber(), day.dayNumber(), static_cast<uint8_t>(cls), 0,
+                         train->getConcessions().mixSignature(passengers)};
+        uint32_t version = train->pricingVersion(day);
+        long long today = Date::today().dayNumber();
+        Money fare;
+        // Version 0: no seat block yet. Quoting does not create one, and a rule change would
+        // have nothing to invalidate, so the fare is computed but not cached
+        if (version == 0) return train->quoteGroupFare(day, passengers, cls);
+        if (!quoteCache.lookup(key, version, today, fare)) {
+            fare = train->quoteGroupFare(day, passengers, cls);
+            quoteCache.store(key, version, today, fare);
+        }
+        return fare;
+    }
+
+    // Bulk concession-aware quotes for a batch of groups (-1 paise where the train or class is
+    // unknown, or the train does not run that day)
+    vector<Money> quoteGroupFares(const vector<GroupRequest>& groups) {
+        vector<Money> quotes;
+        quotes.reserve(groups.size());
+        for (const auto& group : groups) {
+            Train* train = findTrain(group.trainNumber);
+            Date day = Date::parseOr(group.date);
+            quotes.push_back(train && train->offersClass(group.coachClass) && train->runsOn(day)
+                                   ? cachedGroupQuote(train, day, group.passengers, group.coachClass)
+                                   : Money::fromPaise(-1));
+        }
+        return quotes;
+    }
+
     // COORDINATOR FUNCTION: Replaces the old bookTicket
     void coordinateMultipleBookings() {
         int totalGroups;
@@ -986,20 +4589,31 @@ public:
             return;
         }
         
-        vector<Passenger> allPassengers;
+        vector<GroupRequest> groups;
         
         for (int groupIndex = 1; groupIndex <= totalGroups; ++groupIndex) {
-            string tNum, date, dest;
+            string tNum, date, dest, classText, boarding;
             int numPassengers;
+            int cls;
             
             cout << "\n--- Group " << groupIndex << " Details ---" << endl;
             cout << "Enter Train Number: "; cin >> tNum;
             cout << "Enter Date of Journey (MM/DD/YYYY): "; cin >> date;
             
-            if (!isValidDate(date)) { 
+            if (!normalizeDate(date)) { 
                 cout << "❌ Invalid Date Format. Skipping Group " << groupIndex << "." << endl; 
                 continue; 
             }
+
+            cout << "Coach Class (SL/3A/2A/1A): "; cin >> classText;
+            transform(classText.begin(), classText.end(), classText.begin(), ::toupper);
+            if (!parseCoachClass(classText, cls)) {
+                cout << "❌ Unknown class. Skipping Group " << groupIndex << "." << endl;
+                continue;
+            }
+
+            cout << "Boarding Station (- for the train's origin): "; cin >> boarding;
+            if (boarding == "-") boarding.clear();
             
             cout << "Number of Passengers in this group (max 6): "; 
             if (!(cin >> numPassengers) || numPassengers <= 0 || numPassengers > 6) {
@@ -1024,8 +4638,28 @@ public:
                 groupPassengers.emplace_back(name, age, gender);
             }
             
+            groups.push_back({tNum, date, groupPassengers, cls, boarding});
+        }
+
+        // Quote every group in one pass (concessions applied), then book them in order
+        vector<Money> quotes = quoteGroupFares(groups);
+        cout << "\n--- Fare Quote ---" << endl;
+        Money total;
+        for (size_t g = 0; g < groups.size(); ++g) {
+            cout << "    Group " << (g + 1) << " (" << groups[g].trainNumber << ", " << groups[g].date << ", "
+                 << coachClassName(groups[g].coachClass) << ", " << groups[g].passengers.size() << " pax): ";
+            if (quotes[g] < Money()) {
+                cout << "train/class not found or not running that day" << endl;
+            } else {
+                cout << "₹" << quotes[g] << endl;
+                total += quotes[g];
+            }
+        }
+        cout << "    Total: ₹" << total << endl;
+
+        for (const auto& group : groups) {
             // Call the core single-booking logic for this group
-            bookSingleTicket(tNum, date, groupPassengers);
+            bookSingleTicket(group.trainNumber, group.date, group.passengers, group.coachClass, group.boardingStation);
         }
         
         cout << "\n==============================================" << endl;
@@ -1035,51 +4669,58 @@ public:
 
 
     void cancelBooking(const string& pnr) {
-        auto it = find_if(bookings.begin(), bookings.end(), 
-                          [&pnr](const Booking& b){ return b.getPNR() == pnr; });
+        InputCapture::getInstance().record({"CANCEL", pnr});
+        Booking* it = findBooking(pnr);
         
-        if (it != bookings.end()) {
+        if (it) {
             string currentStatus = it->getStatus();
             Train* selectedTrain = findTrain(it->getTrainNumber());
 
             // 1. Transaction Log Start
-            paymentGateway.logTransaction(pnr, "CANCELLATION_ATTEMPT", "PENDING_REFUND");
+            paymentGateway.logTransaction(pnr, "CANCELLATION_ATTEMPT", "PENDING_REFUND", it->getTrainNumber());
 
-            if (currentStatus == "Confirmed") {
+            if (currentStatus == "Confirmed" && selectedTrain && selectedTrain->isChartPrepared(Date::parseOr(it->getDate()))) {
+                cout << "\n❌ Cancellation failed. Chart already prepared for this journey." << endl;
+                paymentGateway.logTransaction(pnr, "CANCELLATION_REJECTED", "CHART_PREPARED", it->getTrainNumber());
+            } else if (currentStatus == "Confirmed") {
                 // 2. Process Refund and Free Seat
                 if (selectedTrain) {
-                    selectedTrain->cancelSeat(it->getDate(), it->getNumPassengers());
+                    int cls = it->getCoachClass();
+                    Date day = Date::parseOr(it->getDate());
+                    selectedTrain->cancelSeat(day, it->getNumPassengers(), cls);
                     
-                    // 3. Process Waitlist Promotion
+                    // 3. Process Waitlist Promotion (same class only)
                     int freedSeats = it->getNumPassengers();
-                    int available = selectedTrain->getAvailableSeats(it->getDate());
+                    int available = selectedTrain->getAvailableSeats(day, cls);
                     
-                    cout << "\n[Promotion Check] " << freedSeats << " seat(s) freed." << endl;
-                    promoteWaitlist(it->getDate(), selectedTrain, available);
+                    cout << "\n[Promotion Check] " << freedSeats << " " << coachClassName(cls) << " seat(s) freed." << endl;
+                    promoteWaitlist(it->getDate(), selectedTrain, cls, available);
 
                     // 4. Finalize Booking and Refund
-                    double refund = it->getTotalFare() * 0.8; // 80% refund mock
+                    Money refund = it->getTotalFare().percent(80); // 80% refund mock
                     paymentGateway.processRefund(refund); // Display refund
                     
                     it->setStatus("Cancelled");
-                    paymentGateway.logTransaction(pnr, "CANCELLATION_SUCCESS", "COMMITTED");
+                    liveAggregates.onCancelled(selectedTrain, *it, currentStatus);
+                    paymentGateway.logTransaction(pnr, "CANCELLATION_SUCCESS", "COMMITTED", it->getTrainNumber());
                     
                     cout << "\n✅ **Cancellation successful** for PNR: **" << pnr << "**" << endl;
-                    cout << "    Refund amount: ₹" << fixed << setprecision(2) << refund << endl;
+                    cout << "    Refund amount: ₹" << refund << endl;
                     saveData();
                 } else {
                     cout << "\n❌ Cancellation failed. Associated Train not found." << endl;
                 }
             } else if (currentStatus == "Waitlist") {
                 // Remove from waitlist map (simplified: 100% refund for WL)
-                double refund = it->getTotalFare();
+                Money refund = it->getTotalFare();
                 paymentGateway.processRefund(refund); // Display refund
 
                 it->setStatus("Cancelled");
-                paymentGateway.logTransaction(pnr, "CANCELLATION_SUCCESS_WL", "COMMITTED");
+                liveAggregates.onCancelled(selectedTrain, *it, currentStatus);
+                paymentGateway.logTransaction(pnr, "CANCELLATION_SUCCESS_WL", "COMMITTED", it->getTrainNumber());
 
                 cout << "\n✅ **Waitlist cancellation successful** for PNR: **" << pnr << "**" << endl;
-                cout << "    Refund amount: ₹" << fixed << setprecision(2) << refund << endl;
+                cout << "    Refund amount: ₹" << refund << endl;
                 saveData();
             } else {
                  cout << "\n❌ Booking " << pnr << " is already **" << it->getStatus() << "**." << endl;
@@ -1090,37 +4731,46 @@ public:
     }
 
     void viewBookingByPNR(const string& pnr) const {
+        if (!pnrGenerator.mayExist(pnr)) { // Never issued: skip the booking scan
+            cout << "\n❌ PNR **" << pnr << "** not found." << endl;
+            return;
+        }
         auto it = find_if(bookings.begin(), bookings.end(), 
                           [&pnr](const Booking& b){ return b.getPNR() == pnr; });
         
+        Booking onDisk; // Not faulted in yet: read just this record
         if (it != bookings.end()) {
             it->displayBooking();
+        } else if (lazyBookings.peek(BOOKING_FILE, pnr, onDisk)) {
+            onDisk.displayBooking();
         } else {
             cout << "\n❌ PNR **" << pnr << "** not found." << endl;
         }
     }
 
     void processWaitlistManual(const string& tNum, const string& date) {
+        InputCapture::getInstance().record({"PROMOTE", tNum, date});
         Train* train = findTrain(tNum);
         if (!train) {
             cout << "❌ Train not found." << endl;
             return;
         }
+        ensureBookingsLoaded(tNum);
 
-        int available = train->getAvailableSeats(date);
+        Date day = Date::parseOr(date);
+        int available = train->getAvailableSeats(day);
         if (available > 0) {
             cout << "\n--- Manually Processing Waitlist for " << tNum << " on " << date << " ---" << endl;
-            promoteWaitlist(date, train, available);
+            for (int c = 0; c < CLASS_COUNT; ++c) {
+                promoteWaitlist(date, train, c, train->getAvailableSeats(day, c));
+            }
         } else {
             cout << "No seats available to promote waitlist." << endl;
         }
     }
     
-    // Destructor to clean up dynamically allocated Train objects and Users
+    // Destructor to clean up dynamically allocated Users
     ~RailwayManager() {
-        for (auto train : trains) {
-            delete train;
-        }
         for (auto user : users) {
             delete user;
         }
@@ -1130,36 +4780,590 @@ public:
 // --- 13. Main Entry Point ---
 
 void handleAddTrain(RailwayManager& manager) {
-    cout << "\n--- Add New Express Train ---" << endl;
-    string num, name, src, dest;
-    int seats;
-    double fare;
+    cout << "\n--- Add New Train ---" << endl;
+    string typeText, num, name, src, dest;
+    TrainType type = TrainType::Express;
+    int seats[CLASS_COUNT] = {};
+    Money fares[CLASS_COUNT];
+    int premiumPct = 0;
+    string fareText;
     string pantry;
-    bool hasPantry;
+    bool hasPantry = false;
     
+    cout << "Enter Train Type (EXPRESS/SUPERFAST/PASSENGER/SPECIAL): ";
+    while (cin >> typeText && (transform(typeText.begin(), typeText.end(), typeText.begin(), ::toupper),
+                               !parseTrainType(typeText, type))) {
+        cout << "    Unknown train type. Please re-enter: ";
+    }
+    if (!cin) return; // Input ended before a valid type was entered
     cout << "Enter Train Number (e.g., ET003): "; cin >> num;
     cout << "Enter Train Name: "; cin.ignore(); getline(cin, name);
     cout << "Enter Source Station: "; cin >> src;
     cout << "Enter Destination Station: "; cin >> dest;
-    
-    cout << "Enter Total Seats: "; 
-    while (!(cin >> seats) || seats <= 0) {
-        cout << "    Invalid seat count. Please re-enter: ";
+
+    // Timetable: origin departure, intermediate halts, terminus arrival. Every prompt loop
+    // below gives up when input ends (EOF) instead of re-prompting forever.
+    auto readTime = [](const string& prompt) {
+        string text;
+        int16_t minutes;
+        cout << prompt;
+        while (!(cin >> text) || !parseClockTime(text, minutes)) {
+            if (!cin) return string(); // Input ended; the caller checks cin
+            cout << "    Invalid time (HH:MM or N/A). Please re-enter: ";
+        }
+        return formatClockTime(minutes);
+    };
+    string departure = readTime("Departure from " + src + " (HH:MM): ");
+    if (!cin) return;
+    string stopList = src + ",N/A," + departure + ";";
+    int halts;
+    cout << "Number of Intermediate Stops: ";
+    while (!(cin >> halts) || halts < 0 || halts > 50) {
+        if (cin.eof()) return;
+        cout << "    Invalid stop count. Please re-enter: ";
         clearInputBuffer();
     }
+    for (int i = 1; i <= halts; ++i) {
+        string station;
+        cout << "    Stop " << i << " Station: ";
+        if (!(cin >> station)) return;
+        string arrival = readTime("    Arrival (HH:MM): ");
+        if (!cin) return;
+        string haltDeparture = readTime("    Departure (HH:MM): ");
+        if (!cin) return;
+        stopList += station + "," + arrival + "," + haltDeparture + ";";
+    }
+    string arrival = readTime("Arrival at " + dest + " (HH:MM): ");
+    if (!cin) return;
+    stopList += dest + "," + arrival + ",N/A;";
     
-    cout << "Enter Base Fare: ₹"; 
-    while (!(cin >> fare) || fare <= 0) {
-        cout << "    Invalid fare. Please re-enter: ";
-        clearInputBuffer();
+    int totalSeats = 0;
+    while (totalSeats == 0) {
+        for (int c = 0; c < CLASS_COUNT; ++c) {
+            cout << "Enter Seats in " << coachClassName(c) << " (0 if not offered): ";
+            while (!(cin >> seats[c]) || seats[c] < 0) {
+                if (cin.eof()) return;
+                cout << "    Invalid seat count. Please re-enter: ";
+                clearInputBuffer();
+            }
+            if (seats[c] == 0) continue;
+            cout << "Enter " << coachClassName(c) << " Base Fare: ₹";
+            while (!(cin >> fareText) || !Money::parse(fareText, fares[c]) || fares[c] <= Money()) {
+                if (!cin) return;
+                cout << "    Invalid fare. Please re-enter: ";
+                clearInputBuffer();
+            }
+            totalSeats += seats[c];
+        }
+        if (totalSeats == 0) cout << "    A train needs at least one class with seats." << endl;
+    }
+    
+    if (type != TrainType::Passenger) {
+        cout << "Has Pantry Car (yes/no)? "; cin >> pantry;
+        hasPantry = (pantry == "yes" || pantry == "Yes" || pantry == "y" || pantry == "Y");
+    }
+    if (type == TrainType::Special) {
+        cout << "Enter Special Fare Premium (%): ";
+        while (!(cin >> premiumPct) || premiumPct < 0) {
+            if (cin.eof()) return;
+            cout << "    Invalid premium. Please re-enter: ";
+            clearInputBuffer();
+        }
     }
     
-    cout << "Has Pantry Car (yes/no)? "; cin >> pantry;
-    hasPantry = (pantry == "yes" || pantry == "Yes" || pantry == "y" || pantry == "Y");
+    string daysText;
+    uint8_t weekdays;
+    cout << "Running Days (Daily, or e.g. Mon,Wed,Fri): ";
+    while (!(cin >> daysText) || !ServiceCalendar::parseWeekdays(daysText, weekdays)) {
+        if (!cin) return;
+        cout << "    Invalid day list. Please re-enter: ";
+    }
     
-    Route r(src, dest);
-    Train* newTrain = new ExpressTrain(num, name, r, seats, fare, hasPantry);
-    manager.addTrain(newTrain);
+    Route r = Route::fromStopList(stopList);
+    Train train(type, num, name, r, seats[CLASS_SL], fares[CLASS_SL], hasPantry, premiumPct);
+    for (int c = CLASS_SL + 1; c < CLASS_COUNT; ++c) train.configureClass(c, seats[c], fares[c]);
+    if (manager.addTrain(train) && weekdays != ServiceCalendar::ALL_DAYS) {
+        ServiceCalendar calendar;
+        calendar.setWeekdays(weekdays);
+        manager.setServiceCalendar(num, calendar);
+    }
+}
+
+// Replay works on copies: the data files are copied into a fresh scratch directory, which
+// becomes the working directory, so replayed saves never touch the live files.
+const string REPLAY_SCRATCH_DIR = "replay_scratch";
+
+bool enterReplayScratch() {
+    namespace fs = std::filesystem;
+    error_code ec;
+    fs::path scratch = fs::absolute(REPLAY_SCRATCH_DIR, ec);
+    fs::remove_all(scratch, ec);
+    if (!fs::create_directories(scratch, ec)) return false;
+    for (const string& file : {TRAIN_FILE, BOOKING_FILE, PNR_FILE, USER_FILE, TX_LOG_FILE, TX_ROLLUP_FILE}) {
+        if (fs::exists(file) && !fs::copy_file(file, scratch / file, ec)) return false;
+    }
+    fs::current_path(scratch, ec);
+    return !ec;
+}
+
+// Replays a capture file against a scratch copy of the data files as fast as possible,
+// then compares the final state digest and reports throughput and per-request latency.
+int runReplay(const string& capturePath) {
+    InputCapture& capture = InputCapture::getInstance();
+    if (!capture.loadReplay(capturePath)) {
+        cerr << "[Replay] Cannot read capture file: " << capturePath << endl;
+        return 1;
+    }
+    if (!enterReplayScratch()) {
+        cerr << "[Replay] Cannot prepare scratch directory " << REPLAY_SCRATCH_DIR << "/" << endl;
+        return 1;
+    }
+    cout << "[Replay] Working on copies of the data files in " << REPLAY_SCRATCH_DIR << "/" << endl;
+    RailwayManager& manager = RailwayManager::getInstance();
+
+    string startDigest = manager.stateDigest();
+    string beginDigest, endDigest;
+    vector<double> latenciesUs;
+    size_t skipped = 0;
+
+    // Silence console rendering so replay measures the system, not the terminal
+    streambuf* consoleBuf = cout.rdbuf(nullptr);
+    AllocStats replayAllocStart = currentAllocStats();
+    auto replayStart = chrono::steady_clock::now();
+
+    while (const vector<string>* rec = capture.nextRecord()) {
+        const vector<string>& f = *rec;
+        const string& tag = f[0];
+        auto opStart = chrono::steady_clock::now();
+        bool isRequest = true;
+        TrainType type;
+
+        try {
+            if (tag == "BEGIN" && f.size() == 2) {
+                beginDigest = f[1];
+                isRequest = false;
+            } else if (tag == "END" && f.size() == 2) {
+                endDigest = f[1];
+                isRequest = false;
+            } else if ((tag == "T" || tag == "D") && f.size() == 2) {
+                capture.setReplayTime(static_cast<time_t>(stoll(f[1])));
+                isRequest = false;
+            } else if (tag == "BOOK" && f.size() >= 3) {
+                vector<Passenger> passengers;
+                stringstream pss(f.size() > 3 ? f[3] : "");
+                string p_segment;
+                while (getline(pss, p_segment, '&')) {
+                    stringstream psss(p_segment);
+                    string p_part;
+                    vector<string> p_parts;
+                    while (getline(psss, p_part, '|')) p_parts.push_back(p_part);
+                    if (p_parts.size() == 3) passengers.emplace_back(p_parts[0], stoi(p_parts[1]), p_parts[2]);
+                }
+                int cls = CLASS_SL; // Captures taken before coach classes have no class field
+                if (f.size() > 4) parseCoachClass(f[4], cls);
+                manager.bookSingleTicket(f[1], f[2], passengers, cls, f.size() > 5 ? f[5] : ""); // Older captures: origin
+            } else if (tag == "CANCEL" && f.size() == 2) {
+                manager.cancelBooking(f[1]);
+            } else if (tag == "PROMOTE" && f.size() == 3) {
+                manager.processWaitlistManual(f[1], f[2]);
+            } else if (tag == "ADD_RULE" && f.size() == 10) {
+                manager.addPricingRule(f[1], {f[2], stoi(f[3]), stoi(f[4]), stoi(f[5]), stoi(f[6]),
+                                              stoi(f[7]), stoi(f[8]), stod(f[9])});
+            } else if (tag == "SET_LADDER" && f.size() == 4) {
+                manager.setFareLadder(f[1], stoi(f[2]), stod(f[3]));
+            } else if (tag == "SET_CALENDAR" && f.size() == 3) {
+                manager.setServiceCalendar(f[1], ServiceCalendar::deserialize(f[2]));
+            } else if (tag == "CHART" && f.size() == 2) {
+                manager.prepareCharts(f[1]);
+            } else if (tag == "REMOVE_TRAIN" && f.size() == 2) {
+                manager.removeTrain(f[1]);
+            } else if (tag == "ADD_TRAIN" && f.size() >= 10 && parseTrainType(f[1], type)) {
+                Route route = f.size() > 10 ? Route::fromStopList(f[10]) : Route(f[4], f[5]);
+                Train train(type, f[2], f[3], route, 0, Money(), f[8] == "1", stoi(f[9]));
+                train.configureClasses(f[6], f[7]);
+                manager.addTrain(train);
+            } else if (tag == "ADD_EXPRESS" && f.size() == 8) { // Captures taken before train types
+                manager.addTrain(Train(TrainType::Express, f[1], f[2], Route(f[3], f[4]), stoi(f[5]),
+                                       Money::parseOrThrow(f[6]), f[7] == "1"));
+            } else {
+                isRequest = false;
+                skipped++;
+            }
+        } catch (const std::exception& e) {
+            cerr << "[Replay] Bad " << tag << " record: " << e.what() << endl;
+            isRequest = false;
+            skipped++;
+        }
+
+        if (isRequest) latenciesUs.push_back(elapsedMsSince(opStart) * 1000.0);
+    }
+
+    double totalMs = elapsedMsSince(replayStart);
+    AllocStats replayAllocs = allocsSince(replayAllocStart);
+    cout.rdbuf(consoleBuf);
+    capture.endReplay();
+
+    string finalDigest = manager.stateDigest();
+    sort(latenciesUs.begin(), latenciesUs.end());
+    auto percentile = [&latenciesUs](double q) {
+        return latenciesUs.empty() ? 0.0 : latenciesUs[static_cast<size_t>(q * (latenciesUs.size() - 1))];
+    };
+
+    cout << "\n==============================================" << endl;
+    cout << "🔁 **REPLAY REPORT**" << endl;
+    cout << "==============================================" << endl;
+    cout << "Requests: " << latenciesUs.size() << " (skipped records: " << skipped << ")" << endl;
+    cout << fixed << setprecision(2);
+    cout << "Elapsed: " << totalMs << " ms, Throughput: "
+         << (totalMs > 0 ? latenciesUs.size() / (totalMs / 1000.0) : 0.0) << " req/s" << endl;
+    cout << "Latency (us): p50 " << percentile(0.50) << ", p99 " << percentile(0.99)
+         << ", max " << percentile(1.0) << endl;
+    cout << "Per request: " << (latenciesUs.empty() ? 0.0 : totalMs * 1e6 / latenciesUs.size()) << " ns/op, "
+         << allocsPerOp(replayAllocs.count, latenciesUs.size()) << " allocs/op, "
+         << allocsPerOp(replayAllocs.bytes, latenciesUs.size()) << " bytes/op" << endl;
+    if (beginDigest != startDigest) {
+        cout << "⚠️ Start state differs from capture (captured " << beginDigest << ", loaded "
+             << startDigest << "). Replay against the data files the capture began with." << endl;
+    }
+    bool match = (!endDigest.empty() && endDigest == finalDigest);
+    cout << "Final state: captured " << (endDigest.empty() ? "<missing>" : endDigest)
+         << ", replayed " << finalDigest << " -> " << (match ? "✅ MATCH" : "❌ MISMATCH") << endl;
+    return match ? 0 : 2;
+}
+
+// --- Storage Format Benchmark (--bench-storage [bookings]) ---
+// Generates one synthetic booking dataset and measures it in the current pipe-delimited
+// text format and two candidates: text snapshot + append-only journal, and a binary
+// snapshot. Reports write/load time, file size, RSS growth after load and update cost.
+
+size_t currentRssKB() {
+#ifdef __linux__
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line)) {
+        if (line.compare(0, 6, "VmRSS:") == 0) {
+            return static_cast<size_t>(stoull(line.substr(6)));
+        }
+    }
+#endif
+    return 0;
+}
+
+size_t fileSizeBytes(const string& path) {
+    ifstream f(path, ios::binary | ios::ate);
+    return f.is_open() ? static_cast<size_t>(f.tellg()) : 0;
+}
+
+// Binary snapshot record: u8-length-prefixed strings, raw fare, u8 status/counts
+void writeBinaryString(ostream& out, const string& str) {
+    unsigned char len = static_cast<unsigned char>(min<size_t>(str.size(), 255));
+    out.put(static_cast<char>(len));
+    out.write(str.data(), len);
+}
+
+string readBinaryString(istream& in) {
+    int len = in.get();
+    if (len <= 0) return "";
+    string str(static_cast<size_t>(len), '\0');
+    in.read(&str[0], len);
+    return str;
+}
+
+void writeBinaryBooking(ostream& out, const Booking& b, const vector<Passenger>& passengers) {
+    writeBinaryString(out, b.getPNR());
+    writeBinaryString(out, b.getTrainNumber());
+    writeBinaryString(out, b.getDate());
+    int64_t fare = b.getTotalFare().toPaise();
+    out.write(reinterpret_cast<const char*>(&fare), sizeof(fare));
+    writeBinaryString(out, b.getStatus());
+    out.put(static_cast<char>(passengers.size()));
+    for (const auto& p : passengers) {
+        writeBinaryString(out, p.getName());
+        out.put(static_cast<char>(p.getAge()));
+        writeBinaryString(out, p.getGender());
+    }
+}
+
+bool readBinaryBooking(istream& in, vector<Booking>& out) {
+    string pnr = readBinaryString(in);
+    if (!in || pnr.empty()) return false;
+    string tNum = readBinaryString(in);
+    string date = readBinaryString(in);
+    int64_t fare = 0;
+    in.read(reinterpret_cast<char*>(&fare), sizeof(fare));
+    string status = readBinaryString(in);
+    int count = in.get();
+    vector<Passenger> passengers;
+    for (int i = 0; i < count && in; ++i) {
+        string name = readBinaryString(in);
+        int age = in.get();
+        string gender = readBinaryString(in);
+        passengers.emplace_back(name, age, gender);
+    }
+    if (!in) return false;
+    out.emplace_back(pnr, tNum, date, passengers, Money::fromPaise(fare), status);
+    return true;
+}
+
+struct StorageBenchResult {
+    string format;
+    double writeMs = 0.0;
+    double loadMs = 0.0;
+    size_t fileBytes = 0;
+    size_t rssKB = 0;
+    double updateUs = 0.0;
+    size_t loaded = 0;
+    AllocStats writeAllocs;
+    AllocStats loadAllocs;
+};
+
+int runStorageBenchmark(size_t numBookings) {
+    const string textPath = "bench_storage.txt";
+    const string journalPath = "bench_storage.journal";
+    const string binaryPath = "bench_storage.bin";
+    const int fullRewriteUpdates = 5;    // text/binary: each update rewrites the file (as saveData does)
+    const int journalUpdates = 1000;     // journal: each update appends one record
+
+    // Generate the dataset once; every format stores exactly these records
+    cout << "[Bench] Generating " << numBookings << " bookings..." << endl;
+    vector<Booking> dataset;
+    vector<vector<Passenger>> datasetPassengers;
+    dataset.reserve(numBookings);
+    datasetPassengers.reserve(numBookings);
+    const char* statuses[] = {"Confirmed", "Confirmed", "Confirmed", "Waitlist", "Cancelled"};
+    for (size_t i = 0; i < numBookings; ++i) {
+        vector<Passenger> passengers;
+        int count = 1 + static_cast<int>(i % 4);
+        for (int p = 0; p < count; ++p) {
+            passengers.emplace_back("Pax" + to_string(i) + "_" + to_string(p), 18 + static_cast<int>((i + p) % 60),
+                                    (p % 2) ? "F" : "M");
+        }
+        stringstream date;
+        date << setfill('0') << setw(2) << (1 + i % 12) << "/" << setw(2) << (1 + i % 28) << "/2026";
+        stringstream tNum;
+        tNum << "T" << setfill('0') << setw(4) << (i % 500);
+        dataset.emplace_back(to_string(100000000000LL + static_cast<long long>(i)), tNum.str(), date.str(),
+                             passengers, Money::fromPaise(12550) * count, statuses[i % 5]);
+        datasetPassengers.push_back(passengers);
+    }
+
+    auto writeText = [&](const string& path) {
+        ofstream file(path, ios::trunc);
+        RecordWriter out(file, "bookings");
+        DataFileMigrator::writeSchemas(out, "bookings");
+        for (const auto& b : dataset) out.write("BOOKING", b.recordFields());
+    };
+    auto writeBinary = [&](const string& path) {
+        ofstream out(path, ios::binary | ios::trunc);
+        for (size_t i = 0; i < dataset.size(); ++i) writeBinaryBooking(out, dataset[i], datasetPassengers[i]);
+    };
+    auto loadText = [](const string& path, vector<Booking>& out) {
+        ifstream in(path);
+        RecordReader reader(in);
+        DataRecord rec;
+        while (reader.next(rec)) {
+            if (rec.tag() == "BOOKING") out.push_back(Booking::fromRecord(rec));
+        }
+    };
+
+    vector<StorageBenchResult> results;
+
+    // 1. Current format: pipe-delimited text, full rewrite per update
+    {
+        StorageBenchResult r;
+        r.format = "text (current)";
+        AllocStats allocStart = currentAllocStats();
+        auto start = chrono::steady_clock::now();
+        writeText(textPath);
+        r.writeMs = elapsedMsSince(start);
+        r.writeAllocs = allocsSince(allocStart);
+        r.fileBytes = fileSizeBytes(textPath);
+
+        size_t rssBefore = currentRssKB();
+        vector<Booking> loaded;
+        allocStart = currentAllocStats();
+        start = chrono::steady_clock::now();
+        loadText(textPath, loaded);
+        r.loadMs = elapsedMsSince(start);
+        r.loadAllocs = allocsSince(allocStart);
+        r.rssKB = currentRssKB() - min(rssBefore, currentRssKB());
+        r.loaded = loaded.size();
+
+        start = chrono::steady_clock::now();
+        for (int u = 0; u < fullRewriteUpdates; ++u) {
+            dataset[u % dataset.size()].setStatus("Cancelled");
+            writeText(textPath);
+        }
+        r.updateUs = elapsedMsSince(start) * 1000.0 / fullRewriteUpdates;
+        results.push_back(r);
+    }
+
+    // 2. Text snapshot + append-only journal of status changes ("S|pnr|status")
+    {
+        StorageBenchResult r;
+        r.format = "text + journal";
+        AllocStats allocStart = currentAllocStats();
+        auto start = chrono::steady_clock::now();
+        writeText(textPath);
+        ofstream(journalPath, ios::trunc).close();
+        r.writeMs = elapsedMsSince(start);
+        r.writeAllocs = allocsSince(allocStart);
+
+        start = chrono::steady_clock::now();
+        {
+            ofstream journal(journalPath, ios::app);
+            for (int u = 0; u < journalUpdates; ++u) {
+                journal << "S|" << dataset[u % dataset.size()].getPNR() << "|Cancelled\n";
+                journal.flush(); // Each update must reach the OS before it is acknowledged
+            }
+        }
+        r.updateUs = elapsedMsSince(start) * 1000.0 / journalUpdates;
+        r.fileBytes = fileSizeBytes(textPath) + fileSizeBytes(journalPath);
+
+        size_t rssBefore = currentRssKB();
+        vector<Booking> loaded;
+        allocStart = currentAllocStats();
+        start = chrono::steady_clock::now();
+        loadText(textPath, loaded);
+        map<string, size_t> pnrIndex;
+        for (size_t i = 0; i < loaded.size(); ++i) pnrIndex[loaded[i].getPNR()] = i;
+        ifstream journal(journalPath);
+        string line;
+        while (getline(journal, line)) {
+            size_t first = line.find('|'), second = line.find('|', first + 1);
+            if (first == string::npos || second == string::npos) continue;
+            auto it = pnrIndex.find(line.substr(first + 1, second - first - 1));
+            if (it != pnrIndex.end()) loaded[it->second].setStatus(line.substr(second + 1));
+        }
+        r.loadMs = elapsedMsSince(start);
+        r.loadAllocs = allocsSince(allocStart);
+        r.rssKB = currentRssKB() - min(rssBefore, currentRssKB());
+        r.loaded = loaded.size();
+        results.push_back(r);
+    }
+
+    // 3. Binary snapshot, full rewrite per update
+    {
+        StorageBenchResult r;
+        r.format = "binary snapshot";
+        AllocStats allocStart = currentAllocStats();
+        auto start = chrono::steady_clock::now();
+        writeBinary(binaryPath);
+        r.writeMs = elapsedMsSince(start);
+        r.writeAllocs = allocsSince(allocStart);
+        r.fileBytes = fileSizeBytes(binaryPath);
+
+        size_t rssBefore = currentRssKB();
+        vector<Booking> loaded;
+        allocStart = currentAllocStats();
+        start = chrono::steady_clock::now();
+        {
+            ifstream in(binaryPath, ios::binary);
+            while (readBinaryBooking(in, loaded)) {}
+        }
+        r.loadMs = elapsedMsSince(start);
+        r.loadAllocs = allocsSince(allocStart);
+        r.rssKB = currentRssKB() - min(rssBefore, currentRssKB());
+        r.loaded = loaded.size();
+
+        start = chrono::steady_clock::now();
+        for (int u = 0; u < fullRewriteUpdates; ++u) {
+            dataset[u % dataset.size()].setStatus("Cancelled");
+            writeBinary(binaryPath);
+        }
+        r.updateUs = elapsedMsSince(start) * 1000.0 / fullRewriteUpdates;
+        results.push_back(r);
+    }
+
+    remove(textPath.c_str());
+    remove(journalPath.c_str());
+    remove(binaryPath.c_str());
+
+    cout << "\n==============================================" << endl;
+    cout << "💾 **STORAGE FORMAT COMPARISON (" << numBookings << " bookings)**" << endl;
+    cout << "==============================================" << endl;
+    cout << left << setw(18) << "Format" << setw(12) << "Write ms" << setw(12) << "Load ms"
+         << setw(14) << "File bytes" << setw(12) << "RSS+ KB" << setw(14) << "Update us" << "Loaded" << endl;
+    cout << string(90, '-') << endl;
+    cout << fixed << setprecision(2);
+    for (const auto& r : results) {
+        cout << left << setw(18) << r.format << setw(12) << r.writeMs << setw(12) << r.loadMs
+             << setw(14) << r.fileBytes << setw(12) << r.rssKB << setw(14) << r.updateUs << r.loaded << endl;
+    }
+    cout << string(90, '-') << endl;
+
+    cout << "\nPer record (" << numBookings << " records):" << endl;
+    cout << left << setw(18) << "Format" << setw(14) << "Write ns/op" << setw(16) << "Write allocs/op"
+         << setw(14) << "Load ns/op" << setw(15) << "Load allocs/op" << "Load bytes/op" << endl;
+    cout << string(90, '-') << endl;
+    for (const auto& r : results) {
+        size_t ops = max<size_t>(numBookings, 1);
+        cout << left << setw(18) << r.format << setw(14) << (r.writeMs * 1e6 / ops)
+             << setw(16) << allocsPerOp(r.writeAllocs.count, ops)
+             << setw(14) << (r.loadMs * 1e6 / ops) << setw(15) << allocsPerOp(r.loadAllocs.count, ops)
+             << allocsPerOp(r.loadAllocs.bytes, ops) << endl;
+    }
+    cout << string(90, '-') << endl;
+    if (!allocProfilingEnabled) cout << "Allocation columns need a build with -DRAIL_ALLOC_PROFILE." << endl;
+    cout << "RSS+ is resident-set growth while the loaded copy is alive (Linux only; freed" << endl;
+    cout << "memory from an earlier format may be reused, so read it as a lower bound)." << endl;
+    return 0;
+}
+
+// --- Aggregation Benchmark (--bench-aggregate [rows]) ---
+// Fills the columnar engine with synthetic bookings and times each grouping, with the
+// allocations each aggregation query makes on the calling thread.
+int runAggregateBenchmark(size_t numRows) {
+    RevenueAggregator agg;
+    const int numTrains = 500, numDays = 365;
+    agg.reserve(numRows, static_cast<size_t>(numTrains) * numDays);
+    vector<string> trainNums, dates;
+    vector<Date> days;
+    for (int t = 0; t < numTrains; ++t) {
+        stringstream tNum;
+        tNum << "T" << setfill('0') << setw(4) << t;
+        trainNums.push_back(tNum.str());
+        agg.addTrain(trainNums.back(), "S" + to_string(t % 40), "D" + to_string((t * 7) % 40));
+    }
+    for (int d = 0; d < numDays; ++d) {
+        stringstream date;
+        date << setfill('0') << setw(2) << (1 + d / 28 % 12) << "/" << setw(2) << (1 + d % 28) << "/2026";
+        dates.push_back(date.str());
+        days.push_back(Date::parseOr(dates.back()));
+    }
+    for (int t = 0; t < numTrains; ++t) {
+        for (int d = 0; d < numDays; ++d) agg.addInventory(trainNums[t], days[d], 500);
+    }
+    const char* statuses[] = {"Confirmed", "Confirmed", "Confirmed", "Waitlist", "Cancelled"};
+    for (size_t i = 0; i < numRows; ++i) {
+        int seats = 1 + static_cast<int>(i % 4);
+        agg.addBooking(trainNums[(i * 31) % numTrains], dates[(i * 17) % numDays], statuses[i % 5], seats, Money::fromPaise(12550) * seats);
+    }
+
+    cout << "\n==============================================" << endl;
+    cout << "⚡ **AGGREGATION BENCHMARK (" << numRows << " rows)**" << endl;
+    cout << "==============================================" << endl;
+    const char* labels[] = {"train", "date", "route"};
+    RevenueAggregator::GroupBy modes[] = {RevenueAggregator::GroupBy::Train, RevenueAggregator::GroupBy::Date,
+                                          RevenueAggregator::GroupBy::Route};
+    vector<unsigned> threadCounts = {1};
+    if (thread::hardware_concurrency() > 1) threadCounts.push_back(thread::hardware_concurrency());
+    for (int m = 0; m < 3; ++m) {
+        for (unsigned threads : threadCounts) {
+            AllocStats allocStart = currentAllocStats();
+            auto start = chrono::steady_clock::now();
+            vector<AggregateRow> rows = agg.aggregate(modes[m], 20260101, 20261231, STATUS_CONFIRMED, threads);
+            double ms = elapsedMsSince(start);
+            AllocStats allocs = allocsSince(allocStart);
+            cout << left << setw(8) << labels[m] << setw(4) << threads << " thread(s): " << fixed << setprecision(2)
+                 << ms << " ms, " << (ms > 0 ? numRows / (ms / 1000.0) / 1e6 : 0.0) << " M rows/s, "
+                 << rows.size() << " groups, " << allocsPerOp(allocs.count, 1) << " allocs/op, "
+                 << allocsPerOp(allocs.bytes, 1) << " bytes/op" << endl;
+        }
+    }
+    if (!allocProfilingEnabled) cout << "Allocation columns need a build with -DRAIL_ALLOC_PROFILE." << endl;
+    else cout << "One op is one aggregation query; worker-thread allocations are not counted." << endl;
+    return 0;
 }
 
 void runUserActions(RailwayManager& manager, bool& running, User* currentUser, bool& shouldSwitch) {
@@ -1175,8 +5379,17 @@ void runUserActions(RailwayManager& manager, bool& running, User* currentUser, b
             cout << "Enter Source Station: "; cin >> tempStr1;
             cout << "Enter Destination Station: "; cin >> tempStr2;
             cout << "Enter Date of Journey (MM/DD/YYYY): "; cin >> tempStr3;
-            if (!isValidDate(tempStr3)) { cout << "❌ Invalid Date Format." << endl; break; }
-            manager.searchTrain(tempStr1, tempStr2, tempStr3);
+            if (!normalizeDate(tempStr3)) { cout << "❌ Invalid Date Format." << endl; break; }
+            {
+                string classText;
+                int cls = -1;
+                cout << "Coach Class (SL/3A/2A/1A, or ALL): "; cin >> classText;
+                transform(classText.begin(), classText.end(), classText.begin(), ::toupper);
+                if (classText != "ALL" && !parseCoachClass(classText, cls)) {
+                    cout << "❌ Unknown class. Showing all classes." << endl;
+                }
+                manager.searchTrain(tempStr1, tempStr2, tempStr3, cls);
+            }
             break;
 
         case 2: // Book New Ticket (Multi-Group)
@@ -1229,7 +5442,7 @@ void runAdminActions(RailwayManager& manager, bool& running, User* currentUser,
 
         case 2: // View Availability by Date
             cout << "Enter Date (MM/DD/YYYY) to check availability: "; cin >> tempStr1;
-            if (!isValidDate(tempStr1)) { cout << "❌ Invalid Date Format." << endl; break; }
+            if (!normalizeDate(tempStr1)) { cout << "❌ Invalid Date Format." << endl; break; }
             manager.viewAllTrains(tempStr1);
             break;
         
@@ -1250,7 +5463,7 @@ void runAdminActions(RailwayManager& manager, bool& running, User* currentUser,
             string tNum, date;
             cout << "Enter Train Number for WL promotion: "; cin >> tNum;
             cout << "Enter Date (MM/DD/YYYY): "; cin >> date;
-            if (isValidDate(date)) {
+            if (normalizeDate(date)) {
                 manager.processWaitlistManual(tNum, date);
             } else {
                 cout << "❌ Invalid Date Format." << endl;
@@ -1258,26 +5471,223 @@ void runAdminActions(RailwayManager& manager, bool& running, User* currentUser,
             break;
         }
 
-        case 7: // Switch User
+        case 7: // View System Stats
+            manager.viewSystemStats();
+            break;
+
+        case 8: { // Export Data
+            string dataset, format, path;
+            cout << "Dataset (bookings/inventory/waitlist): "; cin >> dataset;
+            cout << "Format (csv/ndjson): "; cin >> format;
+            cout << "Output file ('-' for console): "; cin >> path;
+            ofstream file;
+            if (path != "-") {
+                file.open(path, ios::trunc);
+                if (!file.is_open()) { cout << "❌ Cannot open " << path << "." << endl; break; }
+            }
+            long long rows = manager.exportData(dataset, format, path == "-" ? cout : file);
+            if (rows < 0) {
+                cout << "❌ Unknown dataset or format." << endl;
+            } else {
+                cout << "\n✅ Exported " << rows << " " << dataset << " row(s)" << (path == "-" ? "." : " to " + path + ".") << endl;
+            }
+            break;
+        }
+
+        case 9: { // Revenue & Occupancy Report
+            string groupBy, fromDate, toDate;
+            cout << "Group by (train/date/route): "; cin >> groupBy;
+            cout << "From Date (MM/DD/YYYY): "; cin >> fromDate;
+            cout << "To Date (MM/DD/YYYY): "; cin >> toDate;
+            if (!normalizeDate(fromDate) || !normalizeDate(toDate)) { cout << "❌ Invalid Date Format." << endl; break; }
+            if (groupBy == "train") manager.viewRevenueReport(RevenueAggregator::GroupBy::Train, fromDate, toDate);
+            else if (groupBy == "date") manager.viewRevenueReport(RevenueAggregator::GroupBy::Date, fromDate, toDate);
+            else if (groupBy == "route") manager.viewRevenueReport(RevenueAggregator::GroupBy::Route, fromDate, toDate);
+            else cout << "❌ Unknown grouping." << endl;
+            break;
+        }
+
+        case 10: // Live Occupancy Dashboard
+            manager.viewLiveDashboard();
+            break;
+
+        case 11: // Prepare Reservation Charts
+            cout << "Enter Date (MM/DD/YYYY) to prepare charts for: "; cin >> tempStr1;
+            if (!normalizeDate(tempStr1)) { cout << "❌ Invalid Date Format." << endl; break; }
+            manager.prepareCharts(tempStr1);
+            break;
+
+        case 12: { // Transaction Time-Series
+            int bucketMinutes;
+            cout << "Filter (all / train:<Num> / route:<Src>-><Dest>): "; cin >> tempStr1;
+            cout << "Bucket size in minutes (e.g. 1, 60, 1440): ";
+            if (!(cin >> bucketMinutes) || bucketMinutes <= 0) { cout << "❌ Invalid bucket size." << endl; clearInputBuffer(); break; }
+            manager.viewTransactionSeries(tempStr1, bucketMinutes);
+            break;
+        }
+
+        case 13: { // Manage Pricing (Rule / Fare Ladder)
+            string tNum, kind, name, fromDate, toDate;
+            int occLow, occHigh, daysLow, daysHigh;
+            double multiplier;
+            cout << "Enter Train Number: "; cin >> tNum;
+            cout << "Add a rule or set the fare ladder (rule/ladder)? "; cin >> kind;
+            if (kind == "ladder") {
+                int stepPercent;
+                double stepMarkup;
+                cout << "Step size in % sold (e.g. 10, 0 to disable): ";
+                if (!(cin >> stepPercent) || stepPercent < 0 || stepPercent > 100) { cout << "❌ Invalid step." << endl; clearInputBuffer(); break; }
+                cout << "Markup per step (e.g. 0.10 for +10%): ";
+                if (!(cin >> stepMarkup) || stepMarkup < 0) { cout << "❌ Invalid markup." << endl; clearInputBuffer(); break; }
+                manager.setFareLadder(tNum, stepPercent, stepMarkup);
+                break;
+            }
+            cout << "Rule Name: "; cin.ignore(); getline(cin, name);
+            cout << "From Date (MM/DD/YYYY): "; cin >> fromDate;
+            cout << "To Date (MM/DD/YYYY): "; cin >> toDate;
+            if (!normalizeDate(fromDate) || !normalizeDate(toDate)) { cout << "❌ Invalid Date Format." << endl; break; }
+            cout << "Occupancy band % (low high, e.g. 0 101): ";
+            if (!(cin >> occLow >> occHigh)) { cout << "❌ Invalid band." << endl; clearInputBuffer(); break; }
+            cout << "Days-to-departure band (low high, e.g. 0 365): ";
+            if (!(cin >> daysLow >> daysHigh)) { cout << "❌ Invalid band." << endl; clearInputBuffer(); break; }
+            cout << "Multiplier (e.g. 1.25): ";
+            if (!(cin >> multiplier) || multiplier <= 0) { cout << "❌ Invalid multiplier." << endl; clearInputBuffer(); break; }
+            // Commas and separators would break the persisted rule list
+            replace_if(name.begin(), name.end(), [](char c) { return c == ',' || c == '@' || c == '|' || c == '#'; }, ' ');
+            manager.addPricingRule(tNum, {name, dateSortKey(fromDate), dateSortKey(toDate), occLow, occHigh,
+                                          daysLow, daysHigh, multiplier});
+            break;
+        }
+
+        case 14: { // Service Calendar: edits a copy of the train's calendar, then applies it
+            string tNum, kind, dateText, toDate;
+            cout << "Enter Train Number: "; cin >> tNum;
+            const ServiceCalendar* current = manager.serviceCalendarOf(tNum);
+            if (!current) { cout << "❌ Train not found." << endl; break; }
+            ServiceCalendar calendar = *current;
+            cout << "Set running days, validity range, cancel a date or add an extra run (days/range/cancel/extra)? ";
+            cin >> kind;
+            if (kind == "days") {
+                uint8_t weekdays;
+                cout << "Running Days (Daily, or e.g. Mon,Wed,Fri): "; cin >> dateText;
+                if (!ServiceCalendar::parseWeekdays(dateText, weekdays)) { cout << "❌ Invalid day list." << endl; break; }
+                calendar.setWeekdays(weekdays);
+            } else if (kind == "range") {
+                cout << "Valid From (MM/DD/YYYY): "; cin >> dateText;
+                cout << "Valid To (MM/DD/YYYY): "; cin >> toDate;
+                Date from, to;
+                if (!Date::parse(dateText, from) || !Date::parse(toDate, to) || from > to) {
+                    cout << "❌ Invalid Date Range." << endl;
+                    break;
+                }
+                calendar.setValidity(from, to);
+            } else if (kind == "cancel" || kind == "extra") {
+                cout << "Date (MM/DD/YYYY): "; cin >> dateText;
+                Date day;
+                if (!Date::parse(dateText, day)) { cout << "❌ Invalid Date Format." << endl; break; }
+                if (kind == "cancel") calendar.addCancellation(day);
+                else calendar.addExtraRun(day);
+            } else {
+                cout << "❌ Unknown option." << endl;
+                break;
+            }
+            manager.setServiceCalendar(tNum, calendar);
+            break;
+        }
+
+        case 15: // Switch User
             shouldSwitch = true;
             cout << "\n➡️ Switching user..." << endl;
             break;
             
-        case 8: // Exit System
+        case 16: // Exit System
             running = false;
             cout << "\n👋 Thank you for using the Railway Management System. Goodbye!" << endl;
             break;
 
         default:
-            cout << "\n⚠️ Invalid choice. Please try again (1-8)." << endl;
+            cout << "\n⚠️ Invalid choice. Please try again (1-16)." << endl;
             break;
     }
 }
 
 
-int main() {
+// Benchmark size argument: a positive whole number
+bool parseBenchCount(const string& text, size_t& count) {
+    if (text.empty() || text.find_first_not_of("0123456789") != string::npos) return false;
+    try {
+        count = static_cast<size_t>(stoull(text));
+    } catch (const std::exception&) {
+        return false; // Out of range
+    }
+    return count >= 1;
+}
+
+int main(int argc, char* argv[]) {
+    // Startup option --lazy-bookings[=prefetch] may precede any mode below: bookings are then
+    // parsed per train on first access (optionally prefetched in the background)
+    if (argc >= 2 && string(argv[1]).compare(0, 15, "--lazy-bookings") == 0) {
+        string option = argv[1];
+        if (option != "--lazy-bookings" && option != "--lazy-bookings=prefetch") {
+            cerr << "[Startup] Unknown option: " << option << endl;
+            return 1;
+        }
+        RailwayManager::setBookingLoadMode(option == "--lazy-bookings" ? BookingLoadMode::Lazy : BookingLoadMode::LazyPrefetch);
+        argv++;
+        argc--;
+    }
+
+    // Benchmark modes run on synthetic data and never touch the system files
+    if (argc >= 2 && (string(argv[1]) == "--bench-storage" || string(argv[1]) == "--bench-aggregate")) {
+        bool storage = string(argv[1]) == "--bench-storage";
+        size_t count = storage ? 200000 : 10000000;
+        if (argc >= 3 && !parseBenchCount(argv[2], count)) {
+            cerr << "Usage: " << argv[1] << (storage ? " [bookings]" : " [rows]")
+                 << " (a whole number of at least 1)" << endl;
+            return 1;
+        }
+        return storage ? runStorageBenchmark(count) : runAggregateBenchmark(count);
+    }
+
+    // Offline upgrade of version-1 data files (loadData also does this on startup)
+    if (argc >= 2 && string(argv[1]) == "--migrate") {
+        return DataFileMigrator::migrateAll() ? 0 : 1;
+    }
+
+    // Export mode: --export <bookings|inventory|waitlist> <csv|ndjson> [file|-]
+    // Startup chatter is silenced so stdout can be piped straight into other tools.
+    if (argc >= 4 && string(argv[1]) == "--export") {
+        string path = (argc >= 5) ? argv[4] : "-";
+        streambuf* stdoutBuf = cout.rdbuf(nullptr);
+        ostream stdoutSink(stdoutBuf);
+        RailwayManager& exporter = RailwayManager::getInstance();
+        ofstream file;
+        if (path != "-") file.open(path, ios::trunc);
+        long long rows = (path == "-" || file.is_open()) ? exporter.exportData(argv[2], argv[3], path == "-" ? stdoutSink : file) : -2;
+        cout.rdbuf(stdoutBuf);
+        if (rows < 0) {
+            cerr << "[Export] " << (rows == -2 ? "Cannot open " + path : string("Unknown dataset or format")) << endl;
+            return 1;
+        }
+        cerr << "[Export] " << rows << " row(s) written." << endl;
+        return 0;
+    }
+
+    // Optional modes: --capture <file> records all inputs, --replay <file> re-runs them
+    string captureArg = (argc >= 3) ? argv[2] : "";
+    if (argc >= 3 && string(argv[1]) == "--replay") {
+        return runReplay(captureArg); // Loads its own manager from the scratch copies
+    }
+
     // Get the singleton instance of the manager
     RailwayManager& manager = RailwayManager::getInstance();
+    if (argc >= 3 && string(argv[1]) == "--capture") {
+        if (!InputCapture::getInstance().beginCapture(captureArg, manager.stateDigest())) {
+            cerr << "[Capture] Cannot open capture file: " << captureArg << endl;
+            return 1;
+        }
+        cout << "[Capture] Recording inputs to " << captureArg << endl;
+    }
     
     bool systemRunning = true;
     User* currentUser = nullptr;
@@ -1341,6 +5751,7 @@ int main() {
         }
     }
     
+    if (InputCapture::getInstance().isCapturing()) InputCapture::getInstance().endCapture(manager.stateDigest());
     cout << "\n👋 System Shut Down. Data saved successfully." << endl;
     return 0;
 }
\ No newline at end of file